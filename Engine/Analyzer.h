@@ -0,0 +1,232 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+#include "../Models/Pdn.h"
+#include "Engine.h"
+#include "PdnMove.h"
+#include "ThreadPool.h"
+
+/**
+ * Класс Analyzer - пакетный анализ сохраненных партий без окна.
+ * Читает партии PDN из потока, каждую позицию оценивает поиском с ограничением глубины
+ * и времени, пишет ту же партию с комментариями: оценка позиции перед ходом (с точки зрения
+ * ходящего), лучший ход, если сыгран другой, и метки ошибок "?" / "??".
+ * Партии анализируются параллельно на пуле потоков (позиции одной партии - подряд,
+ * с общим кэшем поиска), в обработке одновременно не больше нескольких партий на поток,
+ * а результат пишется в порядке входа - архив может быть больше памяти.
+ */
+class Analyzer
+{
+public:
+    struct Options
+    {
+        int depth = 6;              // Глубина поиска в каждой позиции
+        long long movetime_ms = 0;  // Ограничение времени на позицию (0 - только глубина)
+        unsigned threads = 0;       // Число потоков (0 - по числу ядер)
+    };
+
+    // Итог анализа
+    struct Stats
+    {
+        size_t games = 0, positions = 0, mistakes = 0, blunders = 0;
+        size_t errors = 0; // Партии с нераспознанной позицией или нелегальным ходом
+    };
+
+    Analyzer(const Config* config, const Options& options) : config(config), logic(config), options(options)
+    {
+    }
+
+    // Анализ всех партий из in с записью в out
+    Stats run(istream& in, ostream& out)
+    {
+        ThreadPool pool(options.threads);
+        const size_t max_jobs = 4 * pool.size();
+        deque<shared_ptr<Job>> jobs; // Партии в порядке входа
+        PdnReader reader(in);
+        PdnGame game;
+        while (reader.next(game))
+        {
+            while (jobs.size() >= max_jobs)
+                write_front(jobs, out);
+            auto job = make_shared<Job>();
+            job->game = move(game);
+            jobs.push_back(job);
+            pool.submit([this, job] {
+                analyse(job->game);
+                lock_guard<mutex> lock(done_mutex);
+                job->done = true;
+                done_cv.notify_all();
+            });
+        }
+        while (!jobs.empty())
+            write_front(jobs, out);
+        Stats res;
+        res.games = games;
+        res.positions = positions;
+        res.mistakes = mistakes;
+        res.blunders = blunders;
+        res.errors = errors;
+        return res;
+    }
+
+private:
+    struct Job
+    {
+        PdnGame game;
+        bool done = false;
+    };
+
+    // Оценка одной позиции
+    struct Eval
+    {
+        double score = 0;       // С точки зрения ходящего
+        vector<move_pos> best;  // Лучший ход (пусто - ходов нет)
+    };
+
+    // Ожидание первой партии очереди и ее запись
+    void write_front(deque<shared_ptr<Job>>& jobs, ostream& out)
+    {
+        {
+            unique_lock<mutex> lock(done_mutex);
+            done_cv.wait(lock, [&] { return jobs.front()->done; });
+        }
+        write_pdn(out, jobs.front()->game);
+        out.flush();
+        jobs.pop_front();
+    }
+
+    // Анализ партии: ходы заменяются полной записью, к каждому добавляется комментарий
+    void analyse(PdnGame& game)
+    {
+        thread_local unique_ptr<TranspositionTable> tt;
+        if (!tt && config->settings().bot.hash_mb > 0)
+            tt = make_unique<TranspositionTable>(size_t(config->settings().bot.hash_mb));
+
+        ++games;
+        vector<vector<POS_T>> mtx = start_board();
+        bool color = false;
+        const string fen = game.tag("FEN");
+        const string type = game.tag("GameType");
+        if ((!type.empty() && type.substr(0, 2) != "25") || (!fen.empty() && !fen_to_board(fen, mtx, color)))
+        {
+            game.set_tag("AnalysisError", "unsupported GameType or FEN");
+            ++errors;
+            return;
+        }
+
+        vector<Eval> evals;
+        vector<uint64_t> history; // Позиции после последнего необратимого хода (для повторений)
+        size_t played = 0;
+        bool is_illegal = false;
+        for (; played <= game.moves.size(); ++played)
+        {
+            evals.push_back(evaluate(mtx, color, history, tt.get()));
+            if (played == game.moves.size())
+                break;
+            const auto turns = find_pdn_move(logic, mtx, color, game.moves[played]);
+            if (turns.empty())
+            {
+                is_illegal = true;
+                break;
+            }
+            game.moves[played] = turns_to_str(turns);
+            if (turns[0].xb == -1 && mtx[turns[0].x][turns[0].y] > 2)
+                history.push_back(Zobrist::hash(mtx, color));
+            else
+                history.clear();
+            mtx = logic.make_turns(mtx, turns);
+            color = !color;
+        }
+        positions += evals.size();
+
+        // Комментарии: оценка до хода, лучший ход и потеря от сыгранного (по оценке соперника после хода)
+        game.annotations.assign(game.moves.size(), "");
+        for (size_t k = 0; k < played && k + 1 < evals.size(); ++k)
+        {
+            const Eval& before = evals[k];
+            const double after = evals[k + 1].score; // У соперника
+            const string best = turns_to_str(before.best);
+            string mark;
+            if (best != game.moves[k])
+            {
+                const double after_own = (after <= 0 ? INF : after >= INF ? 0 : 1 / after);
+                if ((before.score >= INF && after_own < INF) || (before.score > 0 && after_own <= 0) ||
+                    after_own * Blunder_ratio < before.score)
+                {
+                    mark = "??";
+                    ++blunders;
+                }
+                else if (after_own * Mistake_ratio < before.score)
+                {
+                    mark = "?";
+                    ++mistakes;
+                }
+            }
+            game.annotations[k] = mark + " {" + Engine::score_to_str(before.score) +
+                                  (best != game.moves[k] ? " best " + best : "") + "}";
+        }
+        // Дальше нелегального хода партия не анализируется
+        if (is_illegal)
+        {
+            game.annotations[played] = " {illegal move}";
+            game.set_tag("AnalysisError", "illegal move " + game.moves[played]);
+            ++errors;
+        }
+        game.set_tag("Annotator", "engine analyse depth " + to_string(options.depth) +
+                                      (options.movetime_ms ? " movetime " + to_string(options.movetime_ms) : ""));
+    }
+
+    // Оценка позиции итеративным углублением до глубины options.depth или до истечения времени
+    Eval evaluate(const vector<vector<POS_T>>& mtx, const bool color, const vector<uint64_t>& history,
+                  TranspositionTable* tt) const
+    {
+        Eval res;
+        if (logic.find_turns(color, mtx).empty())
+            return res; // Ходов нет - поражение
+        SearchControl control;
+        if (options.movetime_ms > 0)
+            control.deadline_ms = SearchControl::now_ms() + options.movetime_ms;
+        if (tt)
+            tt->new_search();
+        for (int d = 0; d <= options.depth; ++d)
+        {
+            SearchParams params;
+            params.depth = d;
+            // Первая итерация всегда доводится до конца, чтобы был хотя бы один ход
+            params.control = (d == 0 ? nullptr : &control);
+            params.history = history;
+            params.tt = tt;
+            auto found = logic.find_best_turns(mtx, color, params);
+            if (found.aborted)
+                break;
+            res.score = found.score;
+            res.best = found.turns;
+            if (res.score >= INF || res.score <= 0)
+                break;
+        }
+        return res;
+    }
+
+private:
+    static constexpr double Mistake_ratio = 1.05; // Во сколько раз упало отношение сил после ошибки
+    static constexpr double Blunder_ratio = 1.15; // ... после грубой ошибки
+
+    const Config* config;
+    const Logic logic;
+    const Options options;
+
+    mutex done_mutex;
+    condition_variable done_cv;
+    atomic<size_t> games{0}, positions{0}, mistakes{0}, blunders{0}, errors{0};
+};
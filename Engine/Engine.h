@@ -0,0 +1,418 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+/**
+ * Класс Engine реализует строковый протокол движка (по одной команде в строке).
+ * Поддерживаемые команды:
+ *  isready                                 -> readyok
+ *  position startpos [moves m1 m2 ...]     - начальная позиция (ходят белые)
+ *  position board <64 символа> <w|b> [moves ...] - произвольная позиция
+ *  go [depth N] [movetime MS] [multipv K] [infinite] [ponder] - поиск хода
+ *  stop                                    - остановить поиск и выдать bestmove
+ *  ponderhit                               - ожидаемый ход сделан, ponder переходит в обычный поиск
+ *  budget MS                               - оставшееся время на партию (-1 - без ограничения)
+ *  quit                                    - завершение работы
+ * Во время поиска выдаются строки "info depth D nodes N time MS score S pv M1 M2 ..."
+ * (при multipv K > 1 - по строке на каждую из K лучших линий: "info depth D multipv I ..."),
+ * по окончании - "bestmove M" (или "bestmove none", если ходов нет).
+ * Итерации углубления и линии Multi-PV используют общий кэш поиска (Bot.HashSizeMB),
+ * постоянный кэш Bot.CacheFile движок только читает.
+ */
+class Engine
+{
+public:
+    using Executor = function<void(function<void()>)>;
+
+    /**
+     * @param config Настройки (оценка позиции, оптимизация, уровни ботов по умолчанию)
+     * @param output Функция вывода одной строки ответа
+     * @param executor Где выполнять поиск (nullptr - в отдельном потоке); сервер передает общий пул
+     */
+    Engine(const Config* config, function<void(const string&)> output, Executor executor = nullptr)
+        : config(config), output(move(output)), logic(config), executor(move(executor))
+    {
+        set_start_position();
+    }
+
+    ~Engine()
+    {
+        stop_search(false);
+    }
+
+    /**
+     * Обрабатывает одну строку протокола.
+     * @return false, если получена команда quit
+     */
+    bool handle(const string& line)
+    {
+        istringstream in(line);
+        string cmd;
+        in >> cmd;
+        if (cmd == "quit")
+        {
+            stop_search(false);
+            return false;
+        }
+        if (cmd == "isready")
+            send("readyok");
+        else if (cmd == "position")
+            cmd_position(in);
+        else if (cmd == "go")
+            cmd_go(in);
+        else if (cmd == "stop")
+            stop_search();
+        else if (cmd == "ponderhit")
+            ponder_hit();
+        else if (cmd == "budget")
+            cmd_budget(in);
+        else if (!cmd.empty())
+            send("info string unknown command " + cmd);
+        return true;
+    }
+
+private:
+    // Потокобезопасный вывод строки
+    void send(const string& line)
+    {
+        lock_guard<mutex> lock(output_mutex);
+        output(line);
+    }
+
+    void set_start_position()
+    {
+        mtx = start_board();
+        color = false;
+    }
+
+    // position startpos | board <mtx> <w|b> [moves ...]
+    void cmd_position(istringstream& in)
+    {
+        stop_search();
+        history.clear();
+        string token;
+        in >> token;
+        if (token == "startpos")
+        {
+            set_start_position();
+        }
+        else if (token == "board")
+        {
+            string str, side;
+            in >> str >> side;
+            vector<vector<POS_T>> new_mtx;
+            if (!str_to_board(str, new_mtx) || new_mtx.size() != 8 || (side != "w" && side != "b"))
+            {
+                send("info string bad position");
+                return;
+            }
+            mtx = new_mtx;
+            color = (side == "b");
+        }
+        else
+        {
+            send("info string bad position");
+            return;
+        }
+        if (in >> token && token == "moves")
+        {
+            while (in >> token)
+            {
+                if (!apply_turns(token))
+                {
+                    send("info string illegal move " + token);
+                    return;
+                }
+            }
+        }
+    }
+
+    // Проверка легальности и применение хода в текстовой записи
+    bool apply_turns(const string& str)
+    {
+        auto turns = str_to_turns(str, mtx);
+        if (turns.empty())
+            return false;
+        const bool reversible = (turns[0].xb == -1 && mtx[turns[0].x][turns[0].y] > 2);
+        const uint64_t hash = Zobrist::hash(mtx, color);
+        auto legal_turns = logic.find_turns(color, mtx);
+        for (auto turn : turns)
+        {
+            bool found = false;
+            for (auto legal : legal_turns)
+            {
+                if (legal == turn && legal.xb == turn.xb && legal.yb == turn.yb)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return false;
+            mtx = logic.make_turn(mtx, turn);
+            if (turn.xb == -1)
+                break;
+            legal_turns = logic.find_turns(turn.x2, turn.y2, mtx);
+            if (!legal_turns.have_beats)
+                break;
+        }
+        // Серия взятий должна быть доведена до конца
+        if (turns.back().xb != -1 && logic.find_turns(turns.back().x2, turns.back().y2, mtx).have_beats)
+            return false;
+        // История для обнаружения повторений: только позиции после последнего необратимого хода
+        if (reversible)
+            history.push_back(hash);
+        else
+            history.clear();
+        color = !color;
+        return true;
+    }
+
+    // go [depth N] [movetime MS] [multipv K] [infinite] [ponder]
+    void cmd_go(istringstream& in)
+    {
+        stop_search();
+        int depth = -1, multi_pv = 1;
+        long long movetime = -1;
+        bool infinite = false, ponder = false;
+        string token;
+        while (in >> token)
+        {
+            if (token == "depth")
+                in >> depth;
+            else if (token == "movetime")
+                in >> movetime;
+            else if (token == "multipv")
+                in >> multi_pv;
+            else if (token == "infinite")
+                infinite = true;
+            else if (token == "ponder")
+                ponder = true;
+        }
+        // Без явной глубины: по времени - до остановки, иначе - уровень бота из настроек
+        if (infinite || (depth < 0 && movetime >= 0))
+            depth = Max_search_depth;
+        else if (depth < 0)
+            depth = config->settings().bot.level[color];
+        // Ход не может занять больше оставшегося бюджета партии
+        if (budget_ms >= 0)
+            movetime = (movetime >= 0 ? min(movetime, budget_ms) : budget_ms);
+
+        lock_guard<mutex> lock(state_mutex);
+        control.stop = false;
+        control.deadline_ms = (movetime >= 0 && !ponder) ? SearchControl::now_ms() + movetime : LLONG_MAX;
+        ponder_movetime = movetime;
+        wait_for_stop = infinite || ponder;
+        is_searching = true;
+        queued_mtx = mtx;
+        queued_color = color;
+        queued_history = history;
+        auto state = make_shared<atomic<int>>(Task_queued);
+        queued_task = state;
+        auto task = [this, state, search_mtx = mtx, search_color = color, depth, search_history = history,
+                     multi_pv = max(1, multi_pv)] {
+            // Задача, отмененная до запуска, не обращается к объекту: он может быть уже уничтожен
+            int expected = Task_queued;
+            if (state->compare_exchange_strong(expected, Task_running))
+                search(search_mtx, search_color, depth, search_history, multi_pv);
+        };
+        if (executor)
+            executor(task);
+        else
+            thread(task).detach();
+    }
+
+    // budget MS - бюджет времени партии, расходуется каждым поиском
+    void cmd_budget(istringstream& in)
+    {
+        long long ms = -1;
+        in >> ms;
+        lock_guard<mutex> lock(state_mutex);
+        budget_ms = max(-1ll, ms);
+    }
+
+    // Переход из ponder в обычный поиск: с этого момента действует movetime
+    void ponder_hit()
+    {
+        lock_guard<mutex> lock(state_mutex);
+        wait_for_stop = false;
+        if (ponder_movetime >= 0)
+            control.deadline_ms = SearchControl::now_ms() + ponder_movetime;
+        send_pending_best();
+    }
+
+    /**
+     * Остановка поиска с ожиданием его завершения. Поиск, который еще ждет в очереди пула
+     * (за поисками других сессий), отменяется, и поток команд его не ждет: вместо него
+     * здесь же выполняется первая итерация (глубина 0), если нужен ответ bestmove.
+     * Запущенный поиск видит control.stop и завершается сразу.
+     * @param report Выдать bestmove за отмененный поиск (false - при закрытии сессии)
+     */
+    void stop_search(const bool report = true)
+    {
+        unique_lock<mutex> lock(state_mutex);
+        control.stop = true;
+        send_pending_best();
+        int expected = Task_queued;
+        if (queued_task && queued_task->compare_exchange_strong(expected, Task_cancelled))
+        {
+            queued_task.reset();
+            if (!report)
+            {
+                is_searching = false;
+                return;
+            }
+            lock.unlock();
+            search(queued_mtx, queued_color, 0, queued_history, 1);
+            return;
+        }
+        queued_task.reset();
+        done_cv.wait(lock, [this] { return !is_searching; });
+    }
+
+    // Выдача bestmove, отложенного до stop/ponderhit (вызывается под state_mutex)
+    void send_pending_best()
+    {
+        if (!has_pending_best)
+            return;
+        has_pending_best = false;
+        send("bestmove " + turns_to_str(pending_best));
+    }
+
+    // Итеративное углубление: каждая завершенная итерация выдает info, прерванная - отбрасывается
+    void search(const vector<vector<POS_T>> search_mtx, const bool search_color, const int depth,
+                const vector<uint64_t> search_history, const int multi_pv)
+    {
+        auto start = SearchControl::now_ms();
+        vector<move_pos> best;
+        if (!logic.find_turns(search_color, search_mtx).empty())
+        {
+            // Кэш создается при первом поиске: сессии без go не занимают память.
+            // Поиски на общем пуле сервера берут кэш потока пула (как Analyzer): память -
+            // число потоков x HashSizeMB при любом числе сессий
+            const int hash_mb = config->settings().bot.hash_mb;
+            TranspositionTable* table = nullptr;
+            if (hash_mb > 0)
+            {
+                thread_local unique_ptr<TranspositionTable> worker_tt;
+                auto& owner = (executor ? worker_tt : tt);
+                if (!owner)
+                    owner = make_unique<TranspositionTable>(size_t(hash_mb));
+                table = owner.get();
+                table->new_search();
+            }
+            // Постоянный кэш партий окна движок только читает
+            const string& cache_file = config->settings().bot.cache_file;
+            if (!cache_file.empty() && !cache)
+                cache = make_unique<SearchCache>(project_path + cache_file, logic.cache_signature(),
+                                                 size_t(config->settings().bot.cache_mb));
+            for (int d = 0; d <= depth; ++d)
+            {
+                SearchParams params;
+                params.depth = d;
+                // Первая итерация всегда доводится до конца, чтобы был хотя бы один ход
+                params.control = (d == 0 ? nullptr : &control);
+                params.history = search_history;
+                params.multi_pv = multi_pv;
+                params.tt = table;
+                params.cache = cache.get();
+                auto res = logic.find_best_turns(search_mtx, search_color, params);
+                if (res.aborted)
+                    break;
+                best = res.turns;
+                for (size_t k = 0; k < res.lines.size(); ++k)
+                {
+                    ostringstream info;
+                    info << "info depth " << d;
+                    if (multi_pv > 1)
+                        info << " multipv " << k + 1;
+                    info << " nodes " << res.nodes << " time " << SearchControl::now_ms() - start << " score "
+                         << score_to_str(res.lines[k].score) << " pv " << line_to_str(res.lines[k].turns);
+                    send(info.str());
+                }
+                // Форсированный результат дальше не уточнится
+                if (res.score >= INF || res.score <= 0)
+                    break;
+            }
+        }
+
+        lock_guard<mutex> lock(state_mutex);
+        if (budget_ms >= 0)
+            budget_ms = max(0ll, budget_ms - (SearchControl::now_ms() - start));
+        // В режимах infinite/ponder bestmove выдается только после stop/ponderhit
+        if (wait_for_stop && !control.stop)
+        {
+            pending_best = best;
+            has_pending_best = true;
+        }
+        else
+        {
+            send("bestmove " + turns_to_str(best));
+        }
+        is_searching = false;
+        done_cv.notify_all(); // Под блокировкой: после нее объект может быть уничтожен
+    }
+
+public:
+    // Оценка в текстовом виде протокола: отношение сил, "win" или "loss"
+    static string score_to_str(const double score)
+    {
+        if (score >= INF)
+            return "win";
+        if (score <= 0)
+            return "loss";
+        ostringstream out;
+        out.precision(4);
+        out << fixed << score;
+        return out.str();
+    }
+
+private:
+    static const int Max_search_depth = 64; // Предел глубины для go infinite
+
+    // Состояния задачи поиска в очереди исполнителя
+    static const int Task_queued = 0, Task_running = 1, Task_cancelled = 2;
+
+    const Config* config;
+    function<void(const string&)> output;
+    mutex output_mutex;
+    const Logic logic;
+
+    unique_ptr<TranspositionTable> tt; // Кэш поиска сессии без общего пула (только поток поиска)
+    unique_ptr<SearchCache> cache;      // Постоянный кэш (только чтение)
+
+    // Текущая позиция и сторона, которая ходит
+    vector<vector<POS_T>> mtx;
+    bool color = false;
+    vector<uint64_t> history; // Хеши позиций после последнего необратимого хода (для повторений)
+
+    // Управление поиском
+    Executor executor;
+    SearchControl control;
+    mutex state_mutex;
+    condition_variable done_cv;
+    bool is_searching = false;
+    bool wait_for_stop = false;
+    shared_ptr<atomic<int>> queued_task; // Состояние последней задачи поиска (Task_*)
+    // Позиция последнего go (для ответа за поиск, отмененный до запуска)
+    vector<vector<POS_T>> queued_mtx;
+    bool queued_color = false;
+    vector<uint64_t> queued_history;
+    long long ponder_movetime = -1;
+    bool has_pending_best = false;
+    vector<move_pos> pending_best;
+
+    // Оставшийся бюджет времени партии в мс (-1 - без ограничения)
+    long long budget_ms = -1;
+};
@@ -0,0 +1,251 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+#include "ReferenceLogic.h"
+
+using namespace std;
+
+/**
+ * Класс Fuzzer - дифференциальная проверка Logic по эталону ReferenceLogic на случайных позициях.
+ * Позиции берутся из партий случайными ходами из начальной позиции (все они достижимы).
+ * В каждой позиции сравниваются множества полных ходов, позиции после каждого хода и
+ * (если depth > 0) оценки поиска Logic без кэша на глубину depth с полным минимаксом.
+ * Найденное расхождение упрощается: фигуры убираются (дамки заменяются простыми), пока
+ * расхождение сохраняется, и печатается в виде позиции движка.
+ * Для международных правил (10 x 10) эталона нет: перед случайными партиями проверяются
+ * позиции с известными полными ходами (Known_positions).
+ */
+class Fuzzer
+{
+public:
+    struct Options
+    {
+        unsigned long long positions = 100000; // Сколько позиций проверить
+        int depth = 2;                         // Глубина сравнения поиска (0 - без поиска)
+        unsigned seed = 1;                     // Зерно партий (одинаковое - те же позиции)
+        size_t max_reports = 10;               // Сколько расхождений печатать
+    };
+
+    struct Stats
+    {
+        unsigned long long positions = 0, turns = 0, searches = 0, mismatches = 0;
+    };
+
+    Fuzzer(const Config* config, const Options& options)
+        : logic(config), logic10(config), reference(config), options(options), rand_eng(options.seed),
+          max_plies(config->settings().game.max_turns)
+    {
+    }
+
+    // Проверка options.positions позиций, расхождения печатаются в out
+    Stats run(ostream& out)
+    {
+        Stats stats;
+        check_known(out, stats);
+        while (stats.positions < options.positions)
+        {
+            auto mtx = start_board();
+            bool color = false;
+            for (int ply = 0; ply < max_plies && stats.positions < options.positions; ++ply)
+            {
+                ++stats.positions;
+                const Mismatch kind = check(mtx, color, nullptr, &stats);
+                if (kind != Mismatch::None && stats.mismatches++ < options.max_reports)
+                    report(out, kind, mtx, color);
+                const auto chains = ReferenceLogic::find_full_turns(color, mtx);
+                if (chains.empty())
+                    break;
+                uniform_int_distribution<size_t> pick(0, chains.size() - 1);
+                mtx = ReferenceLogic::make_turns(mtx, chains[pick(rand_eng)]);
+                color = !color;
+            }
+        }
+        return stats;
+    }
+
+private:
+    // Позиция (ходят белые) и ее полные ходы в записи протокола, отсортированные
+    struct KnownPosition
+    {
+        const char* board;
+        const char* turns;
+    };
+
+    /**
+     * Позиции 10 x 10 с ходами, которые зависят от правил, не проверяемых эталоном.
+     * Турецкий удар: дамка h6 после взятий g7 и d2 не может пройти через клетку побитой g7,
+     * поэтому серия h6:j8:c1:a3 (три взятия, если g7 снимать сразу) невозможна.
+     */
+    static constexpr KnownPosition Known_positions[] = {
+        {"......................................b........W.............w............b.b....b..................",
+         "h6:c1:a3"},
+    };
+
+    // Проверка Known_positions, расхождения считаются и печатаются как "mismatch known ..."
+    void check_known(ostream& out, Stats& stats) const
+    {
+        for (const auto& known : Known_positions)
+        {
+            vector<vector<POS_T>> mtx;
+            str_to_board(known.board, mtx);
+            vector<string> turns;
+            for (const auto& chain : logic10.find_full_turns(false, mtx))
+                turns.push_back(turns_to_str(chain, InternationalDraughts::Size));
+            sort(turns.begin(), turns.end());
+            string actual;
+            for (const auto& turn : turns)
+                actual += (actual.empty() ? "" : " ") + turn;
+            ++stats.positions;
+            if (actual != known.turns && stats.mismatches++ < options.max_reports)
+                out << "mismatch known board " << known.board << " w expected " << known.turns << " actual "
+                    << actual << endl;
+        }
+    }
+
+    enum class Mismatch
+    {
+        None,
+        Turns,    // Разные множества полных ходов
+        Position, // Разные позиции после одного хода
+        Score     // Разные оценки поиска
+    };
+
+    /**
+     * Сравнение Logic с эталоном в позиции mtx с ходом color.
+     * @param details Описание расхождения (если не nullptr)
+     */
+    Mismatch check(const vector<vector<POS_T>>& mtx, const bool color, string* details, Stats* stats) const
+    {
+        const auto expected = describe(ReferenceLogic::find_full_turns(color, mtx), mtx, true);
+        const auto actual = describe(logic.find_full_turns(color, mtx), mtx, false);
+        if (stats)
+            stats->turns += expected.size();
+        if (expected != actual)
+        {
+            if (details)
+                *details = diff_turns(expected, actual);
+            // Одинаковые ходы с разными позициями после них - ошибка make_turn, иначе - генерации ходов
+            return same_moves(expected, actual) ? Mismatch::Position : Mismatch::Turns;
+        }
+        if (options.depth <= 0 || expected.empty())
+            return Mismatch::None;
+        if (stats)
+            ++stats->searches;
+        SearchParams params;
+        params.depth = options.depth;
+        const double actual_score = logic.find_best_turns(mtx, color, params).score;
+        const double expected_score = reference.search(mtx, color, size_t(options.depth));
+        if (fabs(actual_score - expected_score) > Score_eps * max(1.0, fabs(expected_score)))
+        {
+            if (details)
+                *details = "logic " + to_string(actual_score) + " reference " + to_string(expected_score);
+            return Mismatch::Score;
+        }
+        return Mismatch::None;
+    }
+
+    // Полные ходы в виде "ход позиция_после" (отсортированы, повторы сохраняются)
+    vector<string> describe(const vector<vector<move_pos>>& chains, const vector<vector<POS_T>>& mtx,
+        const bool is_reference) const
+    {
+        vector<string> res;
+        for (const auto& chain : chains)
+        {
+            const auto next = (is_reference ? ReferenceLogic::make_turns(mtx, chain) : logic.make_turns(mtx, chain));
+            res.push_back(turns_to_str(chain) + " " + board_to_str(next));
+        }
+        sort(res.begin(), res.end());
+        return res;
+    }
+
+    static bool same_moves(const vector<string>& expected, const vector<string>& actual)
+    {
+        if (expected.size() != actual.size())
+            return false;
+        for (size_t k = 0; k < expected.size(); ++k)
+        {
+            if (expected[k].substr(0, expected[k].find(' ')) != actual[k].substr(0, actual[k].find(' ')))
+                return false;
+        }
+        return true;
+    }
+
+    // Ходы, которые есть только у одной из сторон
+    static string diff_turns(const vector<string>& expected, const vector<string>& actual)
+    {
+        vector<string> missing, extra;
+        set_difference(expected.begin(), expected.end(), actual.begin(), actual.end(), back_inserter(missing));
+        set_difference(actual.begin(), actual.end(), expected.begin(), expected.end(), back_inserter(extra));
+        string res;
+        for (const auto& item : missing)
+            res += (res.empty() ? "" : "; ") + ("missing " + item);
+        for (const auto& item : extra)
+            res += (res.empty() ? "" : "; ") + ("extra " + item);
+        return res;
+    }
+
+    /**
+     * Упрощение расхождения kind: по одной убираются фигуры и дамки заменяются простыми,
+     * пока расхождение того же вида сохраняется
+     */
+    vector<vector<POS_T>> minimize(vector<vector<POS_T>> mtx, const bool color, const Mismatch kind) const
+    {
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (POS_T i = 0; i < 8; ++i)
+            {
+                for (POS_T j = 0; j < 8; ++j)
+                {
+                    if (!mtx[i][j])
+                        continue;
+                    const POS_T piece = mtx[i][j];
+                    // Простая на последнем для нее ряду невозможна
+                    const bool can_demote = (piece > 2 && !(piece == 3 && i == 0) && !(piece == 4 && i == 7));
+                    for (const POS_T replacement : {POS_T(0), POS_T(piece - 2)})
+                    {
+                        if (replacement && !can_demote)
+                            continue;
+                        mtx[i][j] = replacement;
+                        if (check(mtx, color, nullptr, nullptr) == kind)
+                        {
+                            changed = true;
+                            break;
+                        }
+                        mtx[i][j] = piece;
+                    }
+                }
+            }
+        }
+        return mtx;
+    }
+
+    void report(ostream& out, const Mismatch kind, const vector<vector<POS_T>>& mtx, const bool color) const
+    {
+        const char* names[] = {"none", "turns", "position", "score"};
+        const auto small = minimize(mtx, color, kind);
+        string details;
+        check(small, color, &details, nullptr);
+        out << "mismatch " << names[int(kind)] << " board " << board_to_str(small) << " " << (color ? "b" : "w")
+            << " original " << board_to_str(mtx) << " " << details << endl;
+    }
+
+private:
+    static constexpr double Score_eps = 1e-9; // Допустимая относительная разница оценок (порядок сложения)
+
+    const Logic logic;
+    const BasicLogic<InternationalDraughts> logic10;
+    const ReferenceLogic reference;
+    const Options options;
+    default_random_engine rand_eng;
+    const int max_plies; // Длина случайной партии (MaxNumTurns)
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <istream>
+#include <string>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Game/PositionDb.h"
+#include "../Models/Pdn.h"
+#include "PdnMove.h"
+
+/**
+ * Класс Indexer - построение базы позиций (PositionDb) из партий PDN.
+ * Каждая позиция каждой партии (до первого нелегального хода) добавляется с сыгранным
+ * в ней ходом и результатом партии. Партии читаются потоком, записи сбрасываются
+ * во временные файлы, поэтому размер архива не ограничен памятью.
+ */
+class Indexer
+{
+public:
+    struct Stats
+    {
+        size_t games = 0, positions = 0;
+        size_t errors = 0; // Партии с нераспознанной позицией или нелегальным ходом (добавлены до ошибки)
+    };
+
+    Indexer(const Config* config, const string& db_path) : logic(config), builder(db_path)
+    {
+    }
+
+    /**
+     * Добавление всех партий из in и запись базы.
+     * @return false при ошибке записи (error - описание)
+     */
+    bool run(istream& in, Stats& stats, string* error = nullptr)
+    {
+        PdnReader reader(in);
+        PdnGame game;
+        while (reader.next(game))
+            add_game(game, stats);
+        return builder.finish(error);
+    }
+
+private:
+    void add_game(const PdnGame& game, Stats& stats)
+    {
+        ++stats.games;
+        vector<vector<POS_T>> mtx = start_board();
+        bool color = false;
+        const string fen = game.tag("FEN");
+        const string type = game.tag("GameType");
+        if ((!type.empty() && type.substr(0, 2) != "25") || (!fen.empty() && !fen_to_board(fen, mtx, color)))
+        {
+            ++stats.errors;
+            return;
+        }
+        builder.begin_game(result(game.result != "*" ? game.result : game.tag("Result")));
+        for (const auto& text : game.moves)
+        {
+            const auto turns = find_pdn_move(logic, mtx, color, text);
+            if (turns.empty())
+            {
+                ++stats.errors;
+                return;
+            }
+            stats.positions += builder.add(mtx, color, turns);
+            mtx = logic.make_turns(mtx, turns);
+            color = !color;
+        }
+        stats.positions += builder.add(mtx, color, {});
+    }
+
+    static PositionDbBuilder::Result result(const string& text)
+    {
+        if (text == "1-0" || text == "2-0")
+            return PositionDbBuilder::Result::WhiteWin;
+        if (text == "0-1" || text == "0-2")
+            return PositionDbBuilder::Result::BlackWin;
+        if (text == "1/2-1/2" || text == "1-1")
+            return PositionDbBuilder::Result::Draw;
+        return PositionDbBuilder::Result::Unknown;
+    }
+
+private:
+    const Logic logic;
+    PositionDbBuilder builder;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Game/Memory.h"
+#include "../Models/Notation.h"
+#include "../Models/PositionHistory.h"
+
+/**
+ * Класс Match проводит матч двух настроек бота без окна (например, O1 против O2).
+ * Партии начинаются из начальной позиции, цвета чередуются, правила окончания - как в Game.
+ * Используется для проверки, что ускорение поиска не стоит заметной потери силы.
+ */
+class Match
+{
+public:
+    // Участник матча и его статистика
+    struct Side
+    {
+        Side(const Logic* logic, const int depth) : logic(logic), depth(depth)
+        {
+        }
+
+        const Logic* logic;
+        int depth;                     // Уровень бота
+        int wins = 0, draws = 0, losses = 0;
+        int turns = 0;                 // Число сделанных ходов
+        double time_ms = 0;            // Суммарное время поиска
+        unsigned long long nodes = 0;  // Суммарное число узлов
+        SearchStats stats;             // Статистика выборочного поиска
+        MemUsage memory;               // Выделения памяти поиска
+
+        string report() const
+        {
+            ostringstream out;
+            out << "+" << wins << " =" << draws << " -" << losses << " avg_time_ms " << (turns ? time_ms / turns : 0)
+                << " avg_nodes " << (turns ? nodes / turns : 0) << " futility " << stats.futility_prunes << " razoring "
+                << stats.razorings << " lmr " << stats.lmr_reductions << "/" << stats.lmr_researches << " probcut "
+                << stats.probcut_cuts << " extensions " << stats.single_reply_extensions << "/"
+                << stats.capture_extensions << " quiet " << stats.quiet_reductions << " allocs/turn "
+                << (turns ? memory.allocs / turns : 0) << " bytes/turn " << (turns ? memory.bytes / turns : 0);
+            return out.str();
+        }
+    };
+
+    Match(const Config* config)
+        : Max_turns(config->settings().game.max_turns), Repetitions(config->settings().game.repetitions),
+          No_progress_turns(config->settings().game.no_progress_turns)
+    {
+    }
+
+    // Партия first против second, статистика обоих обновляется
+    void play_game(Side& first, Side& second, const bool first_is_white) const
+    {
+        auto mtx = start_board();
+        PositionHistory positions;
+        int turn_num = -1;
+        while (++turn_num < Max_turns)
+        {
+            const bool color = turn_num % 2;
+            Side& side = (color != first_is_white ? first : second);
+            Side& other = (color != first_is_white ? second : first);
+            positions.add(mtx, turn_num);
+            if (positions.is_draw(Repetitions, No_progress_turns))
+                break;
+            // Нет ходов - поражение ходящего
+            if (side.logic->find_turns(color, mtx).empty())
+            {
+                ++side.losses;
+                ++other.wins;
+                return;
+            }
+            SearchParams params;
+            params.depth = side.depth;
+            params.history = positions.since_irreversible();
+            const MemUsage memory = Memory::usage(MemSubsystem::Search);
+            auto start = chrono::steady_clock::now();
+            auto res = side.logic->find_best_turns(mtx, color, params);
+            side.memory += Memory::usage(MemSubsystem::Search) - memory;
+            side.time_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            side.nodes += res.nodes;
+            side.stats += res.stats;
+            ++side.turns;
+            for (auto turn : res.turns)
+                mtx = side.logic->make_turn(mtx, turn);
+        }
+        ++first.draws;
+        ++second.draws;
+    }
+
+private:
+    const int Max_turns;
+    const int Repetitions;
+    const int No_progress_turns;
+};
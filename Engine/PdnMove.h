@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+using namespace std;
+
+/**
+ * Полный легальный ход по записи из файла PDN: "x" вместо ":" допускается, серия взятий
+ * может быть записана сокращенно (начало, конец и часть промежуточных полей).
+ * @return Пустой вектор, если подходящего хода нет или их несколько
+ */
+inline vector<move_pos> find_pdn_move(const Logic& logic, const vector<vector<POS_T>>& mtx, const bool color,
+                                      string text)
+{
+    for (char& c : text)
+        c = (c == 'x' ? ':' : c);
+    vector<pair<POS_T, POS_T>> squares;
+    for (size_t pos = 0; pos + 2 <= text.size(); pos += 3)
+    {
+        POS_T x, y;
+        if (!str_to_cell(text.substr(pos, 2), x, y) || (pos + 2 < text.size() && text[pos + 2] != '-' &&
+                                                        text[pos + 2] != ':'))
+            return {};
+        squares.emplace_back(x, y);
+    }
+    if (squares.size() < 2 || text.size() != 3 * squares.size() - 1)
+        return {};
+
+    vector<move_pos> res;
+    size_t matches = 0;
+    for (const auto& turns : logic.find_full_turns(color, mtx))
+    {
+        if (make_pair(turns[0].x, turns[0].y) != squares[0] ||
+            make_pair(turns.back().x2, turns.back().y2) != squares.back())
+            continue;
+        // Промежуточные поля записи идут в серии по порядку
+        size_t next = 1;
+        for (size_t k = 0; k + 1 < turns.size() && next + 1 < squares.size(); ++k)
+            next += (make_pair(turns[k].x2, turns[k].y2) == squares[next]);
+        if (next + 1 == squares.size())
+        {
+            res = turns;
+            ++matches;
+        }
+    }
+    return matches == 1 ? res : vector<move_pos>{};
+}
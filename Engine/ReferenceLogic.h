@@ -0,0 +1,263 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Move.h"
+
+using namespace std;
+
+/**
+ * Эталонные правила русских шашек для проверки Logic (engine fuzz): генерация ходов
+ * перебором клеток доски 8 x 8 по координатам, как в первой версии Logic, и полный минимакс
+ * без отсечений, кэша и выборочного поиска. Код намеренно простой и не оптимизируется:
+ * ускорения Logic проверяются совпадением с ним.
+ */
+class ReferenceLogic
+{
+public:
+    explicit ReferenceLogic(const Config* config)
+        : scoring_mode(config->settings().bot.scoring), no_progress_limit(config->settings().game.no_progress_turns)
+    {
+    }
+
+    // Ход по правилам первой версии: превращение в дамку - как только простая дошла до последнего ряда
+    static vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, const move_pos& turn)
+    {
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = 0;
+        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
+            mtx[turn.x][turn.y] += 2;
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
+        mtx[turn.x][turn.y] = 0;
+        return mtx;
+    }
+
+    static vector<vector<POS_T>> make_turns(vector<vector<POS_T>> mtx, const vector<move_pos>& turns)
+    {
+        for (const auto& turn : turns)
+            mtx = make_turn(mtx, turn);
+        return mtx;
+    }
+
+    /**
+     * Ходы фигуры (x, y): взятия, если они есть, иначе обычные ходы.
+     * @param have_beats Есть ли взятия
+     */
+    static vector<move_pos> find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx, bool& have_beats)
+    {
+        vector<move_pos> turns;
+        const POS_T type = mtx[x][y];
+        if (type == 1 || type == 2)
+        {
+            // Взятия простой во все четыре стороны
+            for (POS_T i = x - 2; i <= x + 2; i += 4)
+            {
+                for (POS_T j = y - 2; j <= y + 2; j += 4)
+                {
+                    if (i < 0 || i > 7 || j < 0 || j > 7)
+                        continue;
+                    const POS_T xb = (x + i) / 2, yb = (y + j) / 2;
+                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
+                        continue;
+                    turns.emplace_back(x, y, i, j, xb, yb);
+                }
+            }
+        }
+        else
+        {
+            // Взятия дамки: одна фигура соперника на диагонали, за ней - любая пустая клетка
+            for (POS_T i = -1; i <= 1; i += 2)
+            {
+                for (POS_T j = -1; j <= 1; j += 2)
+                {
+                    POS_T xb = -1, yb = -1;
+                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
+                    {
+                        if (mtx[i2][j2])
+                        {
+                            if (mtx[i2][j2] % 2 == type % 2 || xb != -1)
+                                break;
+                            xb = i2;
+                            yb = j2;
+                        }
+                        else if (xb != -1)
+                            turns.emplace_back(x, y, i2, j2, xb, yb);
+                    }
+                }
+            }
+        }
+        have_beats = !turns.empty();
+        if (have_beats)
+            return turns;
+        if (type == 1 || type == 2)
+        {
+            const POS_T i = (type % 2 ? x - 1 : x + 1);
+            for (POS_T j = y - 1; j <= y + 1; j += 2)
+            {
+                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
+                    continue;
+                turns.emplace_back(x, y, i, j);
+            }
+        }
+        else
+        {
+            for (POS_T i = -1; i <= 1; i += 2)
+            {
+                for (POS_T j = -1; j <= 1; j += 2)
+                {
+                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
+                    {
+                        if (mtx[i2][j2])
+                            break;
+                        turns.emplace_back(x, y, i2, j2);
+                    }
+                }
+            }
+        }
+        return turns;
+    }
+
+    // Все полные ходы цвета (серии взятий до конца); взятие обязательно
+    static vector<vector<move_pos>> find_full_turns(const bool color, const vector<vector<POS_T>>& mtx)
+    {
+        vector<vector<move_pos>> quiet, captures;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!mtx[i][j] || mtx[i][j] % 2 == color)
+                    continue;
+                bool have_beats = false;
+                const auto turns = find_turns(i, j, mtx, have_beats);
+                for (const auto& turn : turns)
+                {
+                    vector<move_pos> chain{turn};
+                    if (have_beats)
+                        add_chains(make_turn(mtx, turn), chain, captures);
+                    else
+                        quiet.push_back(chain);
+                }
+            }
+        }
+        return captures.empty() ? quiet : captures;
+    }
+
+    /**
+     * Оценка позиции полным минимаксом на глубину depth (как SearchParams::depth в Logic):
+     * после хода color соперник отвечает на уровне 0, на уровне depth позиция оценивается.
+     * @return Оценка лучшего хода для color (-1, если ходов нет)
+     */
+    double search(const vector<vector<POS_T>>& mtx, const bool color, const size_t depth) const
+    {
+        vector<pair<vector<vector<POS_T>>, bool>> path;
+        double best = -1;
+        for (const auto& chain : find_full_turns(color, mtx))
+        {
+            const bool reversible = is_reversible(mtx, chain);
+            if (reversible)
+                path.emplace_back(mtx, color);
+            best = max(best, value(make_turns(mtx, chain), !color, 0, depth, color, path, reversible ? 1 : 0));
+            if (reversible)
+                path.pop_back();
+        }
+        return best;
+    }
+
+    // Оценка позиции для bot_color (копия первой версии Logic::calc_score)
+    double calc_score(const vector<vector<POS_T>>& mtx, const bool first_bot_color) const
+    {
+        const bool potential = (scoring_mode == ScoringType::NumberAndPotential);
+        double w = 0, wq = 0, b = 0, bq = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                w += (mtx[i][j] == 1);
+                wq += (mtx[i][j] == 3);
+                b += (mtx[i][j] == 2);
+                bq += (mtx[i][j] == 4);
+                if (potential)
+                {
+                    w += 0.05 * (mtx[i][j] == 1) * (7 - i);
+                    b += 0.05 * (mtx[i][j] == 2) * (i);
+                }
+            }
+        }
+        if (!first_bot_color)
+        {
+            swap(b, w);
+            swap(bq, wq);
+        }
+        if (w + wq == 0)
+            return INF;
+        if (b + bq == 0)
+            return 0;
+        const int q_coef = (potential ? 5 : 4);
+        return (b + bq * q_coef) / (w + wq * q_coef);
+    }
+
+private:
+    static void add_chains(const vector<vector<POS_T>>& mtx, vector<move_pos>& chain, vector<vector<move_pos>>& res)
+    {
+        bool have_beats = false;
+        const auto turns = find_turns(chain.back().x2, chain.back().y2, mtx, have_beats);
+        if (!have_beats)
+        {
+            res.push_back(chain);
+            return;
+        }
+        for (const auto& turn : turns)
+        {
+            chain.push_back(turn);
+            add_chains(make_turn(mtx, turn), chain, res);
+            chain.pop_back();
+        }
+    }
+
+    // Обратимый ход - тихий ход дамки
+    static bool is_reversible(const vector<vector<POS_T>>& mtx, const vector<move_pos>& chain)
+    {
+        return chain.size() == 1 && chain[0].xb == -1 && mtx[chain[0].x][chain[0].y] > 2;
+    }
+
+    /**
+     * Минимакс: color ходит на уровне level, bot_color - цвет, для которого считается оценка.
+     * path - позиции перед обратимыми ходами ветки, no_progress - число таких ходов подряд
+     */
+    double value(const vector<vector<POS_T>>& mtx, const bool color, const size_t level, const size_t depth,
+        const bool bot_color, vector<pair<vector<vector<POS_T>>, bool>>& path, const size_t no_progress) const
+    {
+        // Ничья повторением позиции или по правилу отсутствия прогресса
+        if (no_progress >= no_progress_limit && no_progress > 0)
+            return DRAW;
+        for (size_t k = 1; k <= no_progress && k <= path.size(); ++k)
+        {
+            if (path[path.size() - k].second == color && path[path.size() - k].first == mtx)
+                return DRAW;
+        }
+        if (level >= depth)
+            return calc_score(mtx, bot_color);
+        const auto chains = find_full_turns(color, mtx);
+        if (chains.empty())
+            return (color == bot_color ? 0 : INF);
+        double best = (color == bot_color ? -1 : INF + 1);
+        for (const auto& chain : chains)
+        {
+            const bool reversible = is_reversible(mtx, chain);
+            if (reversible)
+                path.emplace_back(mtx, color);
+            const double score = value(make_turns(mtx, chain), !color, level + 1, depth, bot_color, path,
+                                       reversible ? no_progress + 1 : 0);
+            if (reversible)
+                path.pop_back();
+            best = (color == bot_color ? max(best, score) : min(best, score));
+        }
+        return best;
+    }
+
+private:
+    ScoringType scoring_mode;
+    size_t no_progress_limit;
+};
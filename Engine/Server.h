@@ -0,0 +1,182 @@
+#pragma once
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Engine.h"
+#include "ThreadPool.h"
+
+/**
+ * Класс Server - многопартийный режим движка без окна.
+ * Слушает локальный Unix-сокет, каждое соединение может вести много сессий (партий).
+ * Команды соединения (по одной в строке):
+ *  new              -> "session <id>" - создать сессию
+ *  <id> <команда>   - команда протокола Engine для сессии, ответы приходят с префиксом "<id> "
+ *  close <id>       - закрыть сессию
+ *  quit             - закрыть соединение и все его сессии
+ * Поиски всех сессий выполняются на общем пуле потоков.
+ * Настройки (Config) загружаются один раз и разделяются сессиями только для чтения.
+ */
+class Server
+{
+public:
+    /**
+     * @param config Общие настройки движка
+     * @param threads Число потоков поиска (0 - по числу ядер)
+     * @param session_budget_ms Бюджет времени новой сессии в мс (-1 - без ограничения)
+     */
+    Server(const Config* config, const unsigned threads = 0, const long long session_budget_ms = -1)
+        : config(config), pool(threads), session_budget_ms(session_budget_ms)
+    {
+    }
+
+    /**
+     * Принимает соединения на сокете socket_path (блокирующий вызов).
+     * @return 1 при ошибке создания сокета
+     */
+    int run(const string& socket_path)
+    {
+#ifdef _WIN32
+        cerr << "server mode is not supported on this platform" << endl;
+        return 1;
+#else
+        signal(SIGPIPE, SIG_IGN); // Отключившийся клиент не должен завершать сервер
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (listen_fd < 0 || socket_path.size() >= sizeof(addr.sun_path))
+        {
+            cerr << "can't create socket " << socket_path << endl;
+            return 1;
+        }
+        socket_path.copy(addr.sun_path, socket_path.size());
+        unlink(socket_path.c_str());
+        if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) || listen(listen_fd, SOMAXCONN))
+        {
+            cerr << "can't listen on " << socket_path << endl;
+            close(listen_fd);
+            return 1;
+        }
+        cout << "listening on " << socket_path << " with " << pool.size() << " search threads" << endl;
+        while (true)
+        {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+            thread(&Server::serve, this, fd).detach();
+        }
+#endif
+    }
+
+private:
+#ifndef _WIN32
+    // Состояние одного соединения
+    struct Connection
+    {
+        int fd;
+        mutex write_mutex;
+        map<int, unique_ptr<Engine>> sessions;
+
+        void send(const string& line)
+        {
+            lock_guard<mutex> lock(write_mutex);
+            string data = line + "\n";
+            for (size_t pos = 0; pos < data.size();)
+            {
+                auto written = write(fd, data.data() + pos, data.size() - pos);
+                if (written <= 0)
+                    return;
+                pos += size_t(written);
+            }
+        }
+    };
+
+    // Обработка команд одного соединения
+    void serve(const int fd)
+    {
+        Connection conn;
+        conn.fd = fd;
+        string buffer;
+        char chunk[4096];
+        bool is_open = true;
+        while (is_open)
+        {
+            auto got = read(fd, chunk, sizeof(chunk));
+            if (got <= 0)
+                break;
+            buffer.append(chunk, size_t(got));
+            size_t pos;
+            while (is_open && (pos = buffer.find('\n')) != string::npos)
+            {
+                string line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                is_open = handle(conn, line);
+            }
+        }
+        conn.sessions.clear(); // Остановка поисков до закрытия сокета
+        close(fd);
+    }
+
+    // Обработка одной строки соединения, false - закрыть соединение
+    bool handle(Connection& conn, const string& line)
+    {
+        istringstream in(line);
+        string cmd;
+        in >> cmd;
+        if (cmd == "quit")
+            return false;
+        if (cmd == "new")
+        {
+            int id = ++last_session_id;
+            auto output = [&conn, id](const string& answer) { conn.send(to_string(id) + " " + answer); };
+            auto executor = [this](function<void()> task) { pool.submit(move(task)); };
+            conn.sessions[id] = make_unique<Engine>(config, output, executor);
+            if (session_budget_ms >= 0)
+                conn.sessions[id]->handle("budget " + to_string(session_budget_ms));
+            conn.send("session " + to_string(id));
+            return true;
+        }
+        if (cmd == "close")
+        {
+            int id = -1;
+            in >> id;
+            conn.sessions.erase(id);
+            return true;
+        }
+        // <id> <команда сессии>
+        int id = -1;
+        istringstream id_in(cmd);
+        auto session = (id_in >> id) ? conn.sessions.find(id) : conn.sessions.end();
+        if (session == conn.sessions.end())
+        {
+            conn.send("error unknown session " + cmd);
+            return true;
+        }
+        string rest;
+        getline(in, rest);
+        if (!session->second->handle(rest))
+            conn.sessions.erase(session);
+        return true;
+    }
+#endif
+
+private:
+    const Config* config; // Общие настройки (только чтение)
+    ThreadPool pool;      // Общий пул потоков поиска
+    long long session_budget_ms;
+    atomic<int> last_session_id{0};
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Простой пул потоков фиксированного размера с общей очередью задач.
+ * Используется сервером для расчета ходов сразу многих партий.
+ */
+class ThreadPool
+{
+public:
+    // @param threads Число потоков (0 - по числу ядер)
+    explicit ThreadPool(unsigned threads = 0)
+    {
+        if (threads == 0)
+            threads = max(1u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i)
+            workers.emplace_back(&ThreadPool::work, this);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Ожидает выполнения всех поставленных задач и останавливает потоки
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            is_stopped = true;
+        }
+        queue_cv.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    // Постановка задачи в очередь
+    void submit(function<void()> task)
+    {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            tasks.push(move(task));
+        }
+        queue_cv.notify_one();
+    }
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+private:
+    void work()
+    {
+        while (true)
+        {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this] { return is_stopped || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex queue_mutex;
+    condition_variable queue_cv;
+    bool is_stopped = false;
+};
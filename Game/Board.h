@@ -1,10 +1,16 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <fstream>
 #include <vector>
 
 #include "../Models/Move.h"
+#include "../Models/MoveLog.h"
 #include "../Models/Project_path.h"
+#include "Logger.h"
+#include "Memory.h"
+#include "Trace.h"
 
 #ifdef __APPLE__
 #include <SDL2/SDL.h>
@@ -35,8 +41,8 @@ public:
     // Инициализация и первичная отрисовка игрового поля
     int start_draw()
     {
-        // Инициализация SDL
-        if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+        // Инициализация SDL (только окно и события: звук, джойстики и таймеры не нужны)
+        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0)
         {
             print_exception("SDL_Init can't init SDL2 lib");
             return 1;
@@ -66,24 +72,18 @@ public:
         }
 
         // Создание рендерера с оптимизацией
-        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        // (кадр на vsync, отрисовка в текстуру для перерисовки только измененных клеток)
+        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
         if (ren == nullptr)
         {
             print_exception("SDL_CreateRenderer can't create renderer");
             return 1;
         }
 
-        // Загрузка графических ресурсов
-        board = IMG_LoadTexture(ren, board_path.c_str());         // Игровое поле
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str()); // Шашка белая
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str()); // Шашка чёрная
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str()); // Дамка белая
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str()); // Дамка чёрная
-        back = IMG_LoadTexture(ren, back_path.c_str());           // Кнопка возврата
-        replay = IMG_LoadTexture(ren, replay_path.c_str());       // Кнопка повтора
-
-        // Проверка загрузки текстур
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
+        // Загрузка графических ресурсов (один раз за запуск):
+        // игровое поле - отдельная текстура, фигуры, кнопки и итоги игры - в атласе
+        board = IMG_LoadTexture(ren, board_path.c_str()); // Игровое поле
+        if (!board || !load_atlas())
         {
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
@@ -102,46 +102,33 @@ public:
     void redraw()
     {
         game_results = -1;           // Сброс итога игры
-        history_mtx.clear();         // Очистка истории ходов
-        history_beat_series.clear(); // Очистка истории взятий
-        make_start_mtx();            // Начальная расстановка
+        make_start_mtx();            // Начальная расстановка (и сброс журнала ходов)
         clear_active();              // Сброс выделения
         clear_highlight();           // Сброс подсветки
     }
 
-    // Перемещение фигуры с обработкой взятия (расширенная версия)
+    // Перемещение фигуры с обработкой взятия и превращения в дамку (ход записывается в журнал)
     void move_piece(move_pos turn, const int beat_series = 0)
     {
-        // Удаление побитой фигуры при наличии
-        if (turn.xb != -1)
-        {
-            mtx[turn.xb][turn.yb] = 0;
-        }
-        // Основное перемещение
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
-    }
-
-    // Основная логика перемещения фигуры
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
-    {
+        TraceScope trace("move_piece", "board");
         // Проверка допустимости хода
-        if (mtx[i2][j2])
+        if (mtx[turn.x2][turn.y2])
         {
             throw runtime_error("final position is not empty, can't move");
         }
-        if (!mtx[i][j])
+        if (!mtx[turn.x][turn.y])
         {
             throw runtime_error("begin position is empty, can't move");
         }
+        MemScope mem(MemSubsystem::History);
+        history.play(mtx, turn, beat_series); // Выполнение хода с записью в журнал
+        rerender();                           // Обновление отображения
+    }
 
-        // Проверка превращения в дамку
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
-            mtx[i][j] += 2; // 1->3 (белая дамка), 2->4 (черная дамка)
-
-        // Выполнение перемещения
-        mtx[i2][j2] = mtx[i][j];  // Перенос фигуры
-        drop_piece(i, j);         // Очистка исходной позиции
-        add_history(beat_series); // Сохранение в историю
+    // Перемещение фигуры без взятия
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    {
+        move_piece(move_pos(i, j, i2, j2), beat_series);
     }
 
     // Удаление фигуры с доски
@@ -216,15 +203,35 @@ public:
     void rollback()
     {
         // Определение сколько ходов нужно откатить (с учетом серии взятий)
-        auto beat_series = max(1, *(history_beat_series.rbegin()));
-        while (beat_series-- && history_mtx.size() > 1)
-        {
-            history_mtx.pop_back();         // Удаление из истории
-            history_beat_series.pop_back(); // Удаление информации о взятиях
-        }
-        mtx = *(history_mtx.rbegin()); // Восстановление состояния
-        clear_highlight();             // Сброс подсветки
-        clear_active();                // Сброс выделения
+        auto beat_series = max(1, history.last_beat_series());
+        while (beat_series-- && history.undo(mtx)) // Отмена хода по журналу
+            ;
+        clear_highlight(); // Сброс подсветки
+        clear_active();    // Сброс выделения
+    }
+
+    // Повтор отмененного хода (вместе с его серией взятий), false - повторять нечего
+    bool redo()
+    {
+        if (!history.redo(mtx))
+            return false;
+        while (history.last_beat_series() && history.next_beat_series() == history.last_beat_series() + 1)
+            history.redo(mtx); // Следующее взятие той же серии
+        clear_highlight();
+        clear_active();
+        return true;
+    }
+
+    // Число позиций в истории партии (начальная и после каждого сделанного хода)
+    size_t history_size() const
+    {
+        return history.ply() + 1;
+    }
+
+    // Журнал ходов партии (для записи партии и анализа)
+    const MoveLog &get_history() const
+    {
+        return history;
     }
 
     // Отображение результата игры
@@ -234,24 +241,30 @@ public:
         rerender();         // Обновление отображения
     }
 
-    // Обновление размеров окна
+    // Обновление размеров окна (и восстановление кадра после сброса текстур рендерера)
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H); // Получение новых размеров
+        is_frame_valid = false;                 // Кадр нужно собрать заново
         rerender();                             // Перерисовка
     }
 
+    // Окно снова видно (перекрытие снято, окно восстановлено): кадр собирается из всех клеток и выводится
+    void repaint()
+    {
+        for (auto &row : drawn)
+            row.fill(CellView{Dirty_piece});
+        rerender();
+    }
+
     // Очистка ресурсов SDL
     void quit()
     {
         // Уничтожение всех текстур
         SDL_DestroyTexture(board);
-        SDL_DestroyTexture(w_piece);
-        SDL_DestroyTexture(b_piece);
-        SDL_DestroyTexture(w_queen);
-        SDL_DestroyTexture(b_queen);
-        SDL_DestroyTexture(back);
-        SDL_DestroyTexture(replay);
+        SDL_DestroyTexture(atlas);
+        SDL_DestroyTexture(background);
+        SDL_DestroyTexture(frame);
 
         // Уничтожение рендерера и окна
         SDL_DestroyRenderer(ren);
@@ -269,12 +282,35 @@ public:
     }
 
 private:
-    // Добавление текущего состояния в историю
-    void add_history(const int beat_series = 0)
+    // Спрайты атласа (порядок фигур совпадает с кодами клеток 1-4)
+    enum Sprite
     {
-        history_mtx.push_back(mtx);                 // Сохранение состояния доски
-        history_beat_series.push_back(beat_series); // Сохранение информации о взятиях
-    }
+        WhitePiece,
+        BlackPiece,
+        WhiteQueen,
+        BlackQueen,
+        Back,
+        Replay,
+        WhiteWins,
+        BlackWins,
+        Draw,
+        Sprites_count
+    };
+
+    static constexpr POS_T Dirty_piece = -1; // Вид клетки в drawn, не совпадающий ни с одним настоящим
+
+    // Вид клетки в кадре
+    struct CellView
+    {
+        POS_T piece = 0;
+        bool is_highlighted = false;
+        bool is_active = false;
+
+        bool operator==(const CellView &other) const
+        {
+            return piece == other.piece && is_highlighted == other.is_highlighted && is_active == other.is_active;
+        }
+    };
 
     // Создание начальной расстановки фигур
     void make_start_mtx()
@@ -293,142 +329,249 @@ private:
                     mtx[i][j] = 1;
             }
         }
-        add_history(); // Сохранение начального состояния в историю
+        history.reset(mtx); // Начало журнала ходов с начальной позиции
     }
 
-    // Основная функция рендеринга (перерисовки всего содержимого)
-    void rerender()
+    /**
+     * Загрузка фигур, кнопок и итогов игры в одну текстуру-атлас.
+     * Картинки раскладываются полками по убыванию высоты, ширина атласа ограничена
+     * максимальным размером текстуры рендерера.
+     * @return false, если картинку не удалось загрузить или атлас не создан
+     */
+    bool load_atlas()
     {
-        // Очистка рендерера
-        SDL_RenderClear(ren);
-
-        // Отрисовка доски
-        SDL_RenderCopy(ren, board, NULL, NULL);
+        const array<string, Sprites_count> paths{piece_white_path, piece_black_path, queen_white_path, queen_black_path,
+                                                 back_path, replay_path, white_path, black_path, draw_path};
+        array<SDL_Surface *, Sprites_count> images{};
+        bool is_loaded = true;
+        for (int k = 0; k < Sprites_count; ++k)
+        {
+            images[k] = IMG_Load(paths[k].c_str());
+            is_loaded = is_loaded && images[k];
+        }
 
-        // Отрисовка всех фигур
-        for (POS_T i = 0; i < 8; ++i)
+        SDL_Surface *surface = nullptr;
+        if (is_loaded)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            SDL_RendererInfo info{};
+            SDL_GetRendererInfo(ren, &info);
+            const int max_width = (info.max_texture_width > 0 ? min(info.max_texture_width, 4096) : 4096);
+
+            array<int, Sprites_count> order;
+            for (int k = 0; k < Sprites_count; ++k)
+                order[k] = k;
+            sort(order.begin(), order.end(), [&images](int a, int b) { return images[a]->h > images[b]->h; });
+            int x = 0, y = 0, shelf_h = 0, atlas_w = 0;
+            for (int k : order)
+            {
+                if (x + images[k]->w > max_width)
+                {
+                    x = 0;
+                    y += shelf_h;
+                    shelf_h = 0;
+                }
+                sprites[k] = SDL_Rect{x, y, images[k]->w, images[k]->h};
+                x += images[k]->w;
+                shelf_h = max(shelf_h, images[k]->h);
+                atlas_w = max(atlas_w, x);
+            }
+            surface = SDL_CreateRGBSurfaceWithFormat(0, atlas_w, y + shelf_h, 32, SDL_PIXELFORMAT_RGBA32);
+            for (int k = 0; surface && k < Sprites_count; ++k)
             {
-                if (!mtx[i][j])
-                    continue; // Пропуск пустых клеток
-
-                // Расчет позиции для отрисовки
-                int wpos = W * (j + 1) / 10 + W / 120;
-                int hpos = H * (i + 1) / 10 + H / 120;
-                SDL_Rect rect{wpos, hpos, W / 12, H / 12};
-
-                // Выбор текстуры в зависимости от типа фигуры
-                SDL_Texture *piece_texture;
-                if (mtx[i][j] == 1)
-                    piece_texture = w_piece; // Шашка белая
-                else if (mtx[i][j] == 2)
-                    piece_texture = b_piece; // Шашка черная
-                else if (mtx[i][j] == 3)
-                    piece_texture = w_queen; // Дамка белая
-                else
-                    piece_texture = b_queen; // Дамка черная
-
-                // Отрисовка фигуры
-                SDL_RenderCopy(ren, piece_texture, NULL, &rect);
+                SDL_SetSurfaceBlendMode(images[k], SDL_BLENDMODE_NONE); // Копирование вместе с прозрачностью
+                SDL_BlitSurface(images[k], nullptr, surface, &sprites[k]);
             }
         }
+        for (auto image : images)
+            SDL_FreeSurface(image);
+        if (!surface)
+            return false;
+        atlas = SDL_CreateTextureFromSurface(ren, surface);
+        SDL_FreeSurface(surface);
+        if (atlas)
+            SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+        return atlas != nullptr;
+    }
+
+    // Отрисовка спрайта атласа в прямоугольник rect
+    void draw_sprite(const int sprite, const SDL_Rect &rect)
+    {
+        SDL_RenderCopy(ren, atlas, &sprites[sprite], &rect);
+    }
+
+    // Прямоугольник клетки (i, j) на экране
+    SDL_Rect cell_rect(const int i, const int j) const
+    {
+        const int x = W * (j + 1) / 10, y = H * (i + 1) / 10;
+        return SDL_Rect{x, y, W * (j + 2) / 10 - x, H * (i + 2) / 10 - y};
+    }
+
+    // Текущий вид клетки (i, j)
+    CellView cell_view(const POS_T i, const POS_T j) const
+    {
+        return CellView{mtx[i][j], bool(is_highlighted_[i][j]), active_x == i && active_y == j};
+    }
+
+    /**
+     * Сборка кадра заново (первая отрисовка, изменение размера окна, сброс текстур):
+     * поле масштабируется один раз в текстуру фона, фон копируется в кадр,
+     * все клетки помечаются как пустые и будут дорисованы в rerender.
+     * Если рендерер не умеет рисовать в текстуру, кадр не используется (полная перерисовка).
+     */
+    void make_frame()
+    {
+        SDL_DestroyTexture(background);
+        SDL_DestroyTexture(frame);
+        background = frame = nullptr;
+        if (SDL_RenderTargetSupported(ren))
+        {
+            background = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+            frame = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+        }
+        if (!background || !frame)
+        {
+            SDL_DestroyTexture(background);
+            SDL_DestroyTexture(frame);
+            background = frame = nullptr;
+        }
+        else
+        {
+            SDL_SetRenderTarget(ren, background);
+            SDL_RenderCopy(ren, board, NULL, NULL);
+            SDL_SetRenderTarget(ren, frame);
+            SDL_RenderCopy(ren, background, NULL, NULL);
+            SDL_SetRenderTarget(ren, nullptr);
+        }
+        for (auto &row : drawn)
+            row.fill(CellView{});
+        is_frame_valid = true;
+    }
 
-        // Отрисовка подсветки возможных ходов (зеленые рамки)
-        SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
-        const double scale = 2.5;
-        SDL_RenderSetScale(ren, scale, scale);
+    // Перерисовка одной клетки: фон, фигура, подсветка хода (зеленая рамка) или выбор (красная рамка)
+    void draw_cell(const POS_T i, const POS_T j, const CellView &view)
+    {
+        const SDL_Rect cell = cell_rect(i, j);
+        SDL_RenderSetClipRect(ren, &cell); // Рисование не выходит за клетку
+        if (background)
+            SDL_RenderCopy(ren, background, &cell, &cell); // Без кадра поле уже нарисовано целиком
+        if (view.piece)
+        {
+            SDL_Rect rect{W * (j + 1) / 10 + W / 120, H * (i + 1) / 10 + H / 120, W / 12, H / 12};
+            draw_sprite(WhitePiece + view.piece - 1, rect);
+        }
+        if (view.is_highlighted || view.is_active)
+        {
+            if (view.is_active)
+                SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
+            else
+                SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
+            const int t = Highlight_thickness;
+            const SDL_Rect sides[4]{{cell.x, cell.y, cell.w, t},
+                                    {cell.x, cell.y + cell.h - t, cell.w, t},
+                                    {cell.x, cell.y, t, cell.h},
+                                    {cell.x + cell.w - t, cell.y, t, cell.h}};
+            for (auto &side : sides)
+                SDL_RenderFillRect(ren, &side);
+        }
+        SDL_RenderSetClipRect(ren, nullptr);
+    }
+
+    /**
+     * Основная функция рендеринга. В кадре перерисовываются только клетки, вид которых
+     * изменился с прошлой отрисовки; затем кадр, кнопки и итог игры выводятся на экран.
+     * Если ничего не изменилось, экран не обновляется. Темп кадров задает vsync (без SDL_Delay).
+     */
+    void rerender()
+    {
+        if (!ren)
+            return;
+        TraceScope trace("rerender", "render");
+        long long redrawn = 0;
+        const bool is_new_frame = !is_frame_valid;
+        if (is_new_frame)
+            make_frame();
+        bool is_changed = (is_new_frame || shown_results != game_results || !frame);
+
+        // Перерисовка измененных клеток (без кадра - всего поля каждый раз)
+        if (frame)
+            SDL_SetRenderTarget(ren, frame);
+        else
+            SDL_RenderCopy(ren, board, NULL, NULL);
         for (POS_T i = 0; i < 8; ++i)
         {
             for (POS_T j = 0; j < 8; ++j)
             {
-                if (!is_highlighted_[i][j])
+                const CellView view = cell_view(i, j);
+                if (frame && view == drawn[i][j])
                     continue;
-                SDL_Rect cell{
-                    int(W * (j + 1) / 10 / scale),
-                    int(H * (i + 1) / 10 / scale),
-                    int(W / 10 / scale),
-                    int(H / 10 / scale)};
-                SDL_RenderDrawRect(ren, &cell);
+                draw_cell(i, j, view);
+                drawn[i][j] = view;
+                is_changed = true;
+                ++redrawn;
             }
         }
+        if (frame)
+            SDL_SetRenderTarget(ren, nullptr);
+        trace.arg("cells", redrawn);
+        if (!is_changed)
+            return;
 
-        // Отрисовка активной (выделенной) клетки (красная рамка)
-        if (active_x != -1)
-        {
-            SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
-            SDL_Rect active_cell{
-                int(W * (active_y + 1) / 10 / scale),
-                int(H * (active_x + 1) / 10 / scale),
-                int(W / 10 / scale),
-                int(H / 10 / scale)};
-            SDL_RenderDrawRect(ren, &active_cell);
-        }
-        SDL_RenderSetScale(ren, 1, 1); // Восстановление масштаба
+        // Вывод кадра на экран
+        if (frame)
+            SDL_RenderCopy(ren, frame, NULL, NULL);
 
         // Отрисовка кнопок управления
         SDL_Rect rect_left{W / 40, H / 40, W / 15, H / 15};
-        SDL_RenderCopy(ren, back, NULL, &rect_left); // Кнопка "Назад"
+        draw_sprite(Back, rect_left); // Кнопка "Назад"
         SDL_Rect replay_rect{W * 109 / 120, H / 40, W / 15, H / 15};
-        SDL_RenderCopy(ren, replay, NULL, &replay_rect); // Кнопка "Повтор"
+        draw_sprite(Replay, replay_rect); // Кнопка "Повтор"
 
         // Отрисовка результата игры (если есть)
         if (game_results != -1)
         {
-            string result_path = draw_path;
+            int result_sprite = Draw;
             if (game_results == 1)
-                result_path = white_path; // Победа белых
+                result_sprite = WhiteWins; // Победа белых
             else if (game_results == 2)
-                result_path = black_path; // Победа черных
-
-            SDL_Texture *result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result_sprite = BlackWins; // Победа черных
             SDL_Rect res_rect{W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5};
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
+            draw_sprite(result_sprite, res_rect);
         }
+        shown_results = game_results;
 
-        // Обновление экрана
+        // Обновление экрана (ожидание vsync) и обработка событий окна без извлечения
+        // из очереди, чтобы не потерять клик или пробуждение Hand::wake
         SDL_RenderPresent(ren);
-
-        // Небольшая задержка и обработка событий
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+        SDL_PumpEvents();
     }
 
     // Логирование ошибки
     void print_exception(const string &text)
     {
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Error: " << text << ". " << SDL_GetError() << endl;
-        fout.close();
+        log_write(LogLevel::Error, LogRecord("sdl_error")("what", text)("sdl", SDL_GetError()));
     }
 
 public:
     int W = 0; // Ширина окна
     int H = 0; // Высота окна
 
-    // История состояний доски для отмены хода
-    vector<vector<vector<POS_T>>> history_mtx;
-
 private:
     // Указатели на SDL объекты
     SDL_Window *win = nullptr;   // Окно
     SDL_Renderer *ren = nullptr; // Рендерер
 
     // Текстуры:
-    SDL_Texture *board = nullptr;   // Игровое поле
-    SDL_Texture *w_piece = nullptr; // Шашка белая
-    SDL_Texture *b_piece = nullptr; // Шашка черная
-    SDL_Texture *w_queen = nullptr; // Дамка белая
-    SDL_Texture *b_queen = nullptr; // Дамка черная
-    SDL_Texture *back = nullptr;    // Кнопка Возврат
-    SDL_Texture *replay = nullptr;  // Кнопка Повтора
+    SDL_Texture *board = nullptr;      // Игровое поле
+    SDL_Texture *atlas = nullptr;      // Атлас фигур, кнопок и итогов игры
+    SDL_Texture *background = nullptr; // Поле в размере окна (фон для перерисовки клеток)
+    SDL_Texture *frame = nullptr;      // Кадр: поле с фигурами и подсветкой
+
+    array<SDL_Rect, Sprites_count> sprites{}; // Положение спрайтов в атласе
+
+    array<array<CellView, 8>, 8> drawn{}; // Вид клеток, уже нарисованных в кадре
+    bool is_frame_valid = false;          // false - кадр нужно собрать заново
+    int shown_results = -1;               // Итог игры, выведенный на экран
+    static constexpr int Highlight_thickness = 3; // Толщина рамки подсветки в пикселях
 
     // Пути к файлам текстур
     const string textures_path = project_path + "Textures/";
@@ -464,6 +607,6 @@ private:
     // 4 - дамка черная
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
 
-    // История взятий (для правильной отмены хода)
-    vector<int> history_beat_series;
+    // Журнал ходов (для отмены и повтора хода)
+    MoveLog history;
 };
\ No newline at end of file
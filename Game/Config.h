@@ -1,9 +1,92 @@
 #pragma once
+#include <filesystem>
 #include <fstream>
+#include <stdexcept>
+#include <string>
 #include <nlohmann/json.hpp>
+using namespace std;
 using json = nlohmann::json;
 
 #include "../Models/Project_path.h"
+#include "Logger.h"
+
+// Тип оценки позиции ботом
+enum class ScoringType
+{
+    NumberOnly,        // Только количество фигур
+    NumberAndPotential // Количество фигур и их продвижение
+};
+
+// Уровень оптимизации поиска бота
+enum class Optimization
+{
+    O0, // Полный перебор
+    O1, // Альфа-бета отсечения
+    O2  // Альфа-бета и выборочный поиск (раздел Selective)
+};
+
+/**
+ * Типизированные настройки: разбираются и проверяются один раз при загрузке settings.json,
+ * дальше читаются без поиска по JSON. Массивы по цвету индексируются цветом (0 - белые, 1 - черные).
+ */
+struct Settings
+{
+    struct Window
+    {
+        int width = 0, height = 0; // 0 - по размеру экрана
+    } window;
+
+    struct Bot
+    {
+        bool is_bot[2] = {false, false};
+        int level[2] = {0, 0};
+        ScoringType scoring = ScoringType::NumberAndPotential;
+        int delay_ms = 0;
+        long long game_time_ms = 0; // Время бота на партию (0 - каждый ход на полную глубину уровня)
+        bool no_random = false;
+        Optimization optimization = Optimization::O1;
+        string engine_path;
+        long long engine_movetime_ms = 0;
+        int hash_mb = 16; // Размер кэша поиска в МБ (0 - без кэша)
+        string cache_file; // Файл постоянного кэша поиска (пусто - не используется)
+        int cache_mb = 64; // Размер файла постоянного кэша в МБ
+        string book_file;  // База позиций для выбора хода без поиска (пусто - не используется)
+        int book_min_games = 10; // Ход из базы играется, если сыгран не меньше чем в стольких партиях
+        int arena_mb = 0; // Арена временной памяти поиска в МБ на поток (0 - обычная куча)
+    } bot;
+
+    struct Selective
+    {
+        static constexpr int Ply_units = 4; // Продления и сокращения задаются в четвертях хода
+
+        bool late_move_reductions = true, futility = true, razoring = true, probcut = true;
+        int single_reply_extension = 4; // Продление позиции с единственным ходом
+        int capture_extension = 1;      // Продление за каждую взятую фигуру
+        int quiet_reduction = 0;        // Сокращение тихого хода с оценкой намного хуже окна
+    } selective;
+
+    struct Solver
+    {
+        int max_pieces = 6;               // Бот решает позиции с таким числом фигур и меньше (0 - никогда)
+        unsigned long long max_nodes = 100000; // Предел узлов одного решения
+        int table_mb = 16;                // Размер таблицы решателя в МБ
+    } solver;
+
+    struct GameRules
+    {
+        int max_turns = 120;
+        int repetitions = 3;
+        int no_progress_turns = 30;
+    } game;
+
+    struct Log
+    {
+        LogLevel level = LogLevel::Info;
+        size_t max_bytes = 1 << 20; // Размер log.txt до ротации (0 - без ротации)
+        int files = 2;              // Число хранимых старых файлов лога
+        string trace_path;          // Файл трассировки Chrome trace (пусто - трассировка выключена)
+    } log;
+};
 
 /**
  * Класс для работы с конфигурационными настройками приложения.
@@ -22,14 +105,59 @@ public:
      * 
      * Алгоритм работы:
      * 1. Открывает файл настроек "settings.json" в корневой директории проекта
-     * 2. Парсит содержимое файла в JSON-объект
+     * 2. Парсит содержимое файла в JSON-объект (комментарии // допускаются)
      * 3. Закрывает файловый поток
+     * 4. Разбирает и проверяет типизированные настройки
+     * @throws runtime_error если файл некорректен или значение вне допустимого диапазона
      */
     void reload()
     {
-        std::ifstream fin(project_path + "settings.json");
-        fin >> config; // Десериализация JSON в объект config
+        std::ifstream fin(settings_path);
+        if (!fin)
+            throw runtime_error("can't open " + settings_path);
+        json parsed;
+        try
+        {
+            parsed = json::parse(fin, nullptr, true, true); // Десериализация JSON в объект config
+        }
+        catch (const json::exception &e)
+        {
+            throw runtime_error(settings_path + ": " + e.what());
+        }
         fin.close();
+        typed = parse(parsed);
+        config = move(parsed);
+        modified = last_modified();
+    }
+
+    /**
+     * Перезагружает настройки, если файл изменился с прошлой загрузки.
+     * Некорректный файл не применяется (остаются прежние настройки), ошибка пишется в error.
+     * @return true, если настройки перезагружены
+     */
+    bool reload_if_changed(string *error = nullptr)
+    {
+        auto time = last_modified();
+        if (time == modified)
+            return false;
+        modified = time; // Некорректный файл не перечитывается до следующего изменения
+        try
+        {
+            reload();
+            return true;
+        }
+        catch (const runtime_error &e)
+        {
+            if (error)
+                *error = e.what();
+            return false;
+        }
+    }
+
+    // Типизированные настройки (без поиска по JSON)
+    const Settings &settings() const
+    {
+        return typed;
     }
 
     /**
@@ -47,6 +175,156 @@ public:
         return config[setting_dir][setting_name];
     }
 
+    /**
+     * Изменяет параметр в памяти (файл не меняется).
+     * Используется консольными режимами, например для матча двух настроек бота.
+     */
+    void set(const string& setting_dir, const string& setting_name, const json& value)
+    {
+        json changed = config;
+        changed[setting_dir][setting_name] = value;
+        typed = parse(changed);
+        config = move(changed);
+    }
+
+private:
+    // Время изменения файла настроек (при ошибке - минимальное)
+    filesystem::file_time_type last_modified() const
+    {
+        error_code ec;
+        auto time = filesystem::last_write_time(settings_path, ec);
+        return ec ? filesystem::file_time_type::min() : time;
+    }
+
+    // Значение параметра с проверкой наличия и типа
+    template <class T> static T get(const json &data, const string &dir, const string &name)
+    {
+        try
+        {
+            return data.at(dir).at(name).get<T>();
+        }
+        catch (const json::exception &)
+        {
+            throw runtime_error("settings: " + dir + "." + name + " is missing or has a wrong type");
+        }
+    }
+
+    // Необязательный параметр: при отсутствии - fallback (значение по умолчанию Settings)
+    template <class T> static T get(const json &data, const string &dir, const string &name, const T &fallback)
+    {
+        return contains(data, dir, name) ? get<T>(data, dir, name) : fallback;
+    }
+
+    static bool contains(const json &data, const string &dir, const string &name)
+    {
+        return data.contains(dir) && data.at(dir).is_object() && data.at(dir).contains(name);
+    }
+
+    // Целое значение параметра в диапазоне [min_value, max_value]
+    static long long get_int(const json &data, const string &dir, const string &name, const long long min_value,
+                             const long long max_value)
+    {
+        const json *value = nullptr;
+        if (contains(data, dir, name))
+            value = &data.at(dir).at(name);
+        if (!value || !value->is_number_integer())
+            throw runtime_error("settings: " + dir + "." + name + " must be an integer");
+        const long long res = value->get<long long>();
+        if (res < min_value || res > max_value)
+            throw runtime_error("settings: " + dir + "." + name + " must be in [" + to_string(min_value) + ", " +
+                                to_string(max_value) + "]");
+        return res;
+    }
+
+    // Необязательное целое значение в диапазоне (при отсутствии - fallback)
+    static long long get_int(const json &data, const string &dir, const string &name, const long long min_value,
+                             const long long max_value, const long long fallback)
+    {
+        return contains(data, dir, name) ? get_int(data, dir, name, min_value, max_value) : fallback;
+    }
+
+    /**
+     * Разбор и проверка типизированных настроек. Обязательны только параметры первой версии
+     * settings.json (WindowSize, параметры Bot до Optimization, Game.MaxNumTurns), остальные при
+     * отсутствии берутся из значений по умолчанию Settings.
+     */
+    static Settings parse(const json &data)
+    {
+        Settings res;
+        res.window.width = int(get_int(data, "WindowSize", "Width", 0, 16384));
+        res.window.height = int(get_int(data, "WindowSize", "Hight", 0, 16384));
+
+        res.bot.is_bot[0] = get<bool>(data, "Bot", "IsWhiteBot");
+        res.bot.is_bot[1] = get<bool>(data, "Bot", "IsBlackBot");
+        res.bot.level[0] = int(get_int(data, "Bot", "WhiteBotLevel", 0, Max_bot_level));
+        res.bot.level[1] = int(get_int(data, "Bot", "BlackBotLevel", 0, Max_bot_level));
+        const string scoring = get<string>(data, "Bot", "BotScoringType");
+        if (scoring == "NumberOnly")
+            res.bot.scoring = ScoringType::NumberOnly;
+        else if (scoring == "NumberAndPotential")
+            res.bot.scoring = ScoringType::NumberAndPotential;
+        else
+            throw runtime_error("settings: Bot.BotScoringType must be \"NumberOnly\" or \"NumberAndPotential\"");
+        res.bot.delay_ms = int(get_int(data, "Bot", "BotDelayMS", 0, 60000));
+        res.bot.game_time_ms = get_int(data, "Bot", "BotGameTimeMS", 0, 86400000, res.bot.game_time_ms);
+        res.bot.no_random = get<bool>(data, "Bot", "NoRandom");
+        const string optimization = get<string>(data, "Bot", "Optimization");
+        if (optimization == "O0")
+            res.bot.optimization = Optimization::O0;
+        else if (optimization == "O1")
+            res.bot.optimization = Optimization::O1;
+        else if (optimization == "O2")
+            res.bot.optimization = Optimization::O2;
+        else
+            throw runtime_error("settings: Bot.Optimization must be \"O0\", \"O1\" or \"O2\"");
+        res.bot.engine_path = get<string>(data, "Bot", "EnginePath", res.bot.engine_path);
+        res.bot.engine_movetime_ms =
+            get_int(data, "Bot", "EngineMoveTimeMS", 0, 3600000, res.bot.engine_movetime_ms);
+        res.bot.hash_mb = int(get_int(data, "Bot", "HashSizeMB", 0, 4096, res.bot.hash_mb));
+        res.bot.cache_file = get<string>(data, "Bot", "CacheFile", res.bot.cache_file);
+        res.bot.cache_mb = int(get_int(data, "Bot", "CacheSizeMB", 1, 4096, res.bot.cache_mb));
+        res.bot.book_file = get<string>(data, "Bot", "BookFile", res.bot.book_file);
+        res.bot.book_min_games = int(get_int(data, "Bot", "BookMinGames", 1, 1000000, res.bot.book_min_games));
+        res.bot.arena_mb = int(get_int(data, "Bot", "SearchArenaMB", 0, 4096, res.bot.arena_mb));
+
+        auto& selective = res.selective;
+        selective.late_move_reductions =
+            get<bool>(data, "Selective", "LateMoveReductions", selective.late_move_reductions);
+        selective.futility = get<bool>(data, "Selective", "Futility", selective.futility);
+        selective.razoring = get<bool>(data, "Selective", "Razoring", selective.razoring);
+        selective.probcut = get<bool>(data, "Selective", "ProbCut", selective.probcut);
+        selective.single_reply_extension =
+            int(get_int(data, "Selective", "SingleReplyExtension", 0, 8, selective.single_reply_extension));
+        selective.capture_extension =
+            int(get_int(data, "Selective", "CaptureExtension", 0, 8, selective.capture_extension));
+        selective.quiet_reduction = int(get_int(data, "Selective", "QuietReduction", 0, 8, selective.quiet_reduction));
+
+        res.solver.max_pieces = int(get_int(data, "Solver", "MaxPieces", 0, 24, res.solver.max_pieces));
+        res.solver.max_nodes =
+            (unsigned long long)get_int(data, "Solver", "MaxNodes", 1000, 1000000000, (long long)res.solver.max_nodes);
+        res.solver.table_mb = int(get_int(data, "Solver", "TableSizeMB", 1, 4096, res.solver.table_mb));
+
+        res.game.max_turns = int(get_int(data, "Game", "MaxNumTurns", 1, 120));
+        res.game.repetitions = int(get_int(data, "Game", "RepetitionCount", 2, 1000, res.game.repetitions));
+        res.game.no_progress_turns =
+            int(get_int(data, "Game", "NoProgressTurns", 1, 1000, res.game.no_progress_turns));
+
+        const string level = get<string>(data, "Log", "Level", string("info"));
+        const array<string, 4> levels{"debug", "info", "warning", "error"};
+        auto found = find(levels.begin(), levels.end(), level);
+        if (found == levels.end())
+            throw runtime_error("settings: Log.Level must be \"debug\", \"info\", \"warning\" or \"error\"");
+        res.log.level = LogLevel(found - levels.begin());
+        res.log.max_bytes = size_t(get_int(data, "Log", "MaxSizeKB", 0, 1 << 20, res.log.max_bytes / 1024)) * 1024;
+        res.log.files = int(get_int(data, "Log", "Files", 0, 100, res.log.files));
+        res.log.trace_path = get<string>(data, "Log", "TracePath", res.log.trace_path);
+        return res;
+    }
+
 private:
-    json config; // Хранилище конфигурационных данных в формате JSON
+    static constexpr int Max_bot_level = 30; // Наибольший уровень бота (глубина Max_bot_level + 1)
+    string settings_path = project_path + "settings.json"; // Путь к файлу настроек
+    json config;    // Хранилище конфигурационных данных в формате JSON
+    Settings typed; // Разобранные настройки
+    filesystem::file_time_type modified = filesystem::file_time_type::min(); // Время изменения загруженного файла
 };
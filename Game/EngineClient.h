@@ -0,0 +1,344 @@
+#pragma once
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+#include "../Models/Notation.h"
+
+using namespace std;
+
+/**
+ * Класс EngineClient запускает внешний движок (engine) дочерним процессом
+ * и общается с ним по протоколу Engine через stdin/stdout.
+ * Позволяет вынести расчет ходов бота в отдельный процесс.
+ */
+class EngineClient
+{
+public:
+    EngineClient() = default;
+    EngineClient(const EngineClient&) = delete;
+    EngineClient& operator=(const EngineClient&) = delete;
+
+    ~EngineClient()
+    {
+        stop();
+    }
+
+    // Сколько ждать readyok после запуска движка
+    static constexpr int Handshake_timeout_ms = 5000;
+
+    /**
+     * Запускает процесс движка и проверяет, что он отвечает.
+     * @param path Путь к исполняемому файлу движка
+     * @return true, если движок запущен и ответил readyok не позже Handshake_timeout_ms
+     */
+    bool start(const string& path)
+    {
+        stop();
+#ifdef _WIN32
+        SECURITY_ATTRIBUTES sa{sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+        HANDLE child_in = nullptr, child_out = nullptr;
+        if (!CreatePipe(&child_out, &out_fd, &sa, 0) || !CreatePipe(&in_fd, &child_in, &sa, 0))
+            return false;
+        SetHandleInformation(out_fd, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(in_fd, HANDLE_FLAG_INHERIT, 0);
+        STARTUPINFOA si{};
+        si.cb = sizeof(si);
+        si.dwFlags = STARTF_USESTDHANDLES;
+        si.hStdInput = child_out;
+        si.hStdOutput = child_in;
+        si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+        string cmd = "\"" + path + "\"";
+        bool ok = CreateProcessA(nullptr, &cmd[0], nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &si,
+                                 &process);
+        CloseHandle(child_in);
+        CloseHandle(child_out);
+        if (!ok)
+        {
+            close_pipes();
+            return false;
+        }
+#else
+        int to_child[2], from_child[2];
+        if (pipe(to_child) || pipe(from_child))
+            return false;
+        pid = fork();
+        if (pid < 0)
+            return false;
+        if (pid == 0)
+        {
+            // Дочерний процесс: перенаправляем stdin/stdout в каналы и запускаем движок
+            dup2(to_child[0], STDIN_FILENO);
+            dup2(from_child[1], STDOUT_FILENO);
+            close(to_child[0]);
+            close(to_child[1]);
+            close(from_child[0]);
+            close(from_child[1]);
+            execl(path.c_str(), path.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        close(to_child[0]);
+        close(from_child[1]);
+        out_fd = to_child[1];
+        in_fd = from_child[0];
+        signal(SIGPIPE, SIG_IGN); // Падение движка не должно завершать игру
+#endif
+        running = true;
+        send("isready");
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(Handshake_timeout_ms);
+        string line;
+        while (read_line(line, deadline))
+        {
+            if (line == "readyok")
+                return true;
+        }
+        // Движок не ответил: он может не читать stdin, поэтому quit не поможет
+#ifdef _WIN32
+        TerminateProcess(process.hProcess, 1);
+#else
+        kill(pid, SIGKILL);
+#endif
+        stop();
+        return false;
+    }
+
+    // Завершение работы движка
+    void stop()
+    {
+        if (!running)
+            return;
+        send("stop");
+        send("quit");
+        close_pipes();
+#ifdef _WIN32
+        WaitForSingleObject(process.hProcess, 1000);
+        CloseHandle(process.hProcess);
+        CloseHandle(process.hThread);
+#else
+        waitpid(pid, nullptr, 0);
+#endif
+        running = false;
+    }
+
+    bool is_running() const
+    {
+        return running;
+    }
+
+    /**
+     * Запрашивает у движка лучший ход для позиции.
+     * Движку передается позиция после последнего необратимого хода и обратимые ходы после нее,
+     * поэтому ничьи повторением и без прогресса он считает так же, как игра.
+     * @param boards Позиции в начале ходов после последнего необратимого хода (последняя - текущая)
+     * @param color Цвет ходящего в текущей позиции (false - белые, true - черные)
+     * @param depth Глубина поиска (уровень бота)
+     * @param movetime Ограничение времени в мс (0 - без ограничения)
+     * @return Серия ходов одной фигуры или пустой вектор при ошибке движка или прерывании
+     */
+    vector<move_pos> find_best_turns(const vector<vector<vector<POS_T>>>& boards, const bool color,
+                                     const int depth, const int movetime = 0)
+    {
+        if (!running || boards.empty())
+            return {};
+        const bool first_color = (color != ((boards.size() - 1) % 2 == 1));
+        string position = "position board " + board_to_str(boards.front()) + (first_color ? " b" : " w");
+        if (boards.size() > 1)
+        {
+            position += " moves";
+            for (size_t k = 1; k < boards.size(); ++k)
+                position += " " + quiet_move(boards[k - 1], boards[k]);
+        }
+        send(position);
+        string go = "go depth " + to_string(depth);
+        if (movetime > 0)
+            go += " movetime " + to_string(movetime);
+        {
+            // Прерывание до отправки go: поиск не запускается
+            lock_guard<mutex> lock(think_mutex);
+            if (interrupted || !send(go))
+            {
+                interrupted = false;
+                return {};
+            }
+            is_thinking = true;
+        }
+        vector<move_pos> res;
+        string line;
+        bool is_done = false;
+        while (read_line(line))
+        {
+            if (line.compare(0, 9, "bestmove ") == 0)
+            {
+                res = str_to_turns(line.substr(9), boards.back());
+                is_done = true;
+                break;
+            }
+        }
+        {
+            lock_guard<mutex> lock(think_mutex);
+            is_thinking = false;
+            if (interrupted)
+                res.clear(); // Ход прерванного поиска не играется
+            interrupted = false;
+        }
+        // Движок завершился во время поиска
+        if (!is_done)
+        {
+            lock_guard<mutex> lock(think_mutex);
+            stop();
+        }
+        return res;
+    }
+
+    /**
+     * Прерывание find_best_turns из другого потока (окно закрыто во время хода):
+     * движок получает stop и сразу отвечает bestmove.
+     */
+    void interrupt()
+    {
+        lock_guard<mutex> lock(think_mutex);
+        if (!running)
+            return;
+        interrupted = true;
+        if (is_thinking)
+            send("stop");
+    }
+
+private:
+    // Тихий ход между соседними позициями окна (других ходов после необратимого нет)
+    static string quiet_move(const vector<vector<POS_T>>& from, const vector<vector<POS_T>>& to)
+    {
+        POS_T x = 0, y = 0, x2 = 0, y2 = 0;
+        for (POS_T i = 0; i < POS_T(from.size()); ++i)
+        {
+            for (POS_T j = 0; j < POS_T(from.size()); ++j)
+            {
+                if (from[i][j] && !to[i][j])
+                {
+                    x = i;
+                    y = j;
+                }
+                else if (!from[i][j] && to[i][j])
+                {
+                    x2 = i;
+                    y2 = j;
+                }
+            }
+        }
+        return turns_to_str({move_pos(x, y, x2, y2)}, POS_T(from.size()));
+    }
+
+    bool send(const string& line)
+    {
+        string data = line + "\n";
+#ifdef _WIN32
+        DWORD written = 0;
+        return WriteFile(out_fd, data.data(), DWORD(data.size()), &written, nullptr) && written == data.size();
+#else
+        return write(out_fd, data.data(), data.size()) == ssize_t(data.size());
+#endif
+    }
+
+    // Чтение одной строки ответа, false при закрытии канала или по истечении deadline
+    bool read_line(string& line,
+                   const chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max())
+    {
+        line.clear();
+        while (true)
+        {
+            auto pos = buffer.find('\n');
+            if (pos != string::npos)
+            {
+                line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                return true;
+            }
+            if (deadline != chrono::steady_clock::time_point::max() && !wait_input(deadline))
+                return false;
+            char chunk[4096];
+#ifdef _WIN32
+            DWORD got = 0;
+            if (!ReadFile(in_fd, chunk, sizeof(chunk), &got, nullptr) || got == 0)
+                return false;
+#else
+            ssize_t got = read(in_fd, chunk, sizeof(chunk));
+            if (got <= 0)
+                return false;
+#endif
+            buffer.append(chunk, size_t(got));
+        }
+    }
+
+    // Ожидание данных от движка до deadline, false - не дождались
+    bool wait_input(const chrono::steady_clock::time_point deadline) const
+    {
+        while (true)
+        {
+            const auto left =
+                chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+            if (left <= 0)
+                return false;
+#ifdef _WIN32
+            // Анонимный канал не ожидается через WaitForSingleObject, поэтому опрашиваем его
+            DWORD available = 0;
+            if (!PeekNamedPipe(in_fd, nullptr, 0, nullptr, &available, nullptr))
+                return true; // Канал закрыт: ReadFile сообщит об этом
+            if (available)
+                return true;
+            Sleep(10);
+#else
+            pollfd fd{in_fd, POLLIN, 0};
+            const int ready = poll(&fd, 1, int(left));
+            if (ready > 0)
+                return true; // Данные или закрытие канала
+            if (ready < 0 && errno != EINTR)
+                return false;
+#endif
+        }
+    }
+
+    void close_pipes()
+    {
+#ifdef _WIN32
+        CloseHandle(out_fd);
+        CloseHandle(in_fd);
+        out_fd = in_fd = nullptr;
+#else
+        close(out_fd);
+        close(in_fd);
+        out_fd = in_fd = -1;
+#endif
+        buffer.clear();
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE out_fd = nullptr; // Запись в stdin движка
+    HANDLE in_fd = nullptr;  // Чтение из stdout движка
+    PROCESS_INFORMATION process{};
+#else
+    int out_fd = -1; // Запись в stdin движка
+    int in_fd = -1;  // Чтение из stdout движка
+    pid_t pid = -1;
+#endif
+    bool running = false;
+    string buffer; // Непрочитанный остаток вывода движка
+
+    mutex think_mutex;        // Согласует go и stop из потоков поиска и окна
+    bool is_thinking = false; // Отправлен go, bestmove еще не получен
+    bool interrupted = false; // Вызван interrupt, ход текущего запроса не играется
+};
@@ -1,12 +1,22 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 
 #include "../Models/Project_path.h"
+#include "../Models/PositionHistory.h"
 #include "Board.h"
 #include "Config.h"
+#include "EngineClient.h"
 #include "Hand.h"
+#include "Logger.h"
 #include "Logic.h"
+#include "Memory.h"
+#include "PositionDb.h"
+#include "Solver.h"
+#include "TimeManager.h"
+#include "Trace.h"
 
 /**
  * Основной класс, управляющий игровым процессом в шашках.
@@ -17,53 +27,106 @@ class Game
 {
   public:
       /**
-     * Инициализирует игровые компоненты и очищает лог-файл.
+     * Инициализирует игровые компоненты и запускает лог (файл очищается).
      */
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game() : board(config.settings().window.width, config.settings().window.height), hand(&board), logic(&config)
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        configure_log();
+        create_cache();
+    }
+
+    // Записи поиска этого запуска дописываются в постоянный кэш
+    ~Game()
+    {
+        save_cache();
     }
     /**
-     * Запускает и управляет игровым процессом.
+     * Запускает и управляет игровым процессом. Переигровки идут в цикле без пересоздания
+     * окна, текстур, логики и кэшей поиска: сбрасывается только состояние партии, а настройки
+     * перечитываются, только если файл изменился.
      * @return Код результата игры (0 - выход, 1 - победа черных, 2 - ничья)
      */
     int play()
     {
-        // Засекаем время начала игры 
-        auto start = chrono::steady_clock::now();
+        board.start_draw();                 // Окно и текстуры создаются один раз за запуск
+        while (true)
+        {
+            const int res = play_game();
+            if (res != Replay)
+                return res;
+            reload_config();                // Перечитываем конфигурацию (если файл изменился)
+            board.redraw();                 // Начальная расстановка без пересоздания окна
+        }
+    }
+
+  private:
+    static constexpr int Replay = -1; // Результат play_game: игрок начал новую партию
 
-        // Инициализация режима игры
-        if (is_replay) {
-            logic = Logic(&board, &config);  // Пересоздаем логику игры
-            config.reload();                // Перезагружаем конфигурацию
-            board.redraw();                  // Перерисовываем доску
+    // Сброс состояния партии перед ее началом (кэши поиска и решателя сохраняются)
+    void new_game()
+    {
+        positions.clear();
+        boards.clear();
+        timer.start_game(config.settings().bot.game_time_ms);
+        for (bool color : {false, true})
+        {
+            solver_hint[color] = false;
+            solver_failed_pieces[color] = INT_MAX;
         }
-        else {
-            board.start_draw();              // Начальная отрисовка доски для новой игры
+        ++games;
+    }
+
+    /**
+     * Одна партия с начальной позиции на доске.
+     * @return Код результата игры (как у play) или Replay
+     */
+    int play_game()
+    {
+        // Засекаем время начала игры 
+        auto start = chrono::steady_clock::now();
+        new_game();
+        // Снимок счетчиков памяти: в конце партии в лог пишутся выделения за партию
+        MemUsage game_memory[Memory::Subsystems];
+        for (size_t s = 0; s < Memory::Subsystems; ++s)
+            game_memory[s] = Memory::usage(MemSubsystem(s));
+        const unsigned long long game_overflows = Memory::arena_overflows();
+
+        // Запуск внешнего движка, если он указан в настройках (процесс остается между партиями)
+        const string engine_path = config.settings().bot.engine_path;
+        if (!engine_path.empty() && !engine.is_running() && !engine.start(engine_path)) {
+            log_write(LogLevel::Error, LogRecord("engine_start_failed")("path", engine_path)("fallback", "logic"));
         }
-        is_replay = false;                  // Сбрасываем флаг реплея
 
         int turn_num = -1;                  // Номер хода (-1 так как сначала ++)
         bool is_quit = false;               // Флаг выхода из игры
-        const int Max_turns = config("Game", "MaxNumTurns"); // Макс. число ходов из конфига
+        bool is_replay = false;             // Игрок начал новую партию
+        bool is_draw = false;               // Ничья повторением или без прогресса
+        const int Max_turns = config.settings().game.max_turns; // Макс. число ходов из конфига
 
         // Главный игровой цикл
         while (++turn_num < Max_turns) {
+            TraceScope turn_trace("turn", "game");
+            turn_trace.arg("turn", turn_num);
             beat_series = 0;  // Сбрасываем счетчик серии взятий
 
+            // Запоминаем позицию и проверяем ничью повторением/без прогресса
+            if (add_position(turn_num)) {
+                is_draw = true;
+                break;
+            }
+
             // Находим возможные ходы для текущего игрока (0 - белые, 1 - черные)
-            logic.find_turns(turn_num % 2);
+            auto turns = logic.find_turns(turn_num % 2, board.get_board());
 
             // Если ходов нет - игра завершается
-            if (logic.turns.empty()) break;
+            if (turns.empty()) break;
 
-            // Устанавливаем уровень сложности бота для текущего игрока
-            logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
+            // Настройки, измененные во время партии, применяются со следующего хода
+            reload_config();
 
             // Если текущий игрок - человек (не бот)
-            if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot"))) {
-                auto resp = player_turn(turn_num % 2);  // Обрабатываем ход игрока
+            if (!config.settings().bot.is_bot[turn_num % 2]) {
+                auto resp = player_turn(turn_num % 2, turns);  // Обрабатываем ход игрока
 
                 if (resp == Response::QUIT) {   // Выход из игры
                     is_quit = true;
@@ -75,8 +138,8 @@ class Game
                 }
                 else if (resp == Response::BACK) {    // Отмена хода
                     // Особые условия отмены при игре против бота
-                    if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2) {
+                    if (config.settings().bot.is_bot[1 - turn_num % 2] &&
+                        !beat_series && board.history_size() > 2) {
                         board.rollback();
                         --turn_num;
                     }
@@ -87,25 +150,36 @@ class Game
                     beat_series = 0;
                 }
             }
-            else {
-                bot_turn(turn_num % 2);  // Ход бота
+            else if (bot_turn(turn_num % 2, turn_num) == Response::QUIT) {  // Ход бота
+                is_quit = true;   // Окно закрыто во время хода бота
+                break;
             }
         }
 
         // Замер времени игры и запись в лог
         auto end = chrono::steady_clock::now();
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        log_write(LogLevel::Info, LogRecord("game_end")
+                                      ("time_ms", (long long)chrono::duration<double, milli>(end - start).count())
+                                      ("turns", turn_num)("quit", is_quit)("replay", is_replay)("game", games)
+                                      ("peak_rss_kb", Memory::peak_resident_bytes() / 1024)
+                                      ("arena_overflows", Memory::arena_overflows() - game_overflows));
+        for (size_t s = 0; s < Memory::Subsystems; ++s) {
+            const MemUsage used = Memory::usage(MemSubsystem(s)) - game_memory[s];
+            if (used.allocs)
+                log_write(LogLevel::Info, LogRecord("game_memory")("game", games)
+                                              ("subsystem", Memory::name(MemSubsystem(s)))("allocs", used.allocs)
+                                              ("frees", used.frees)("bytes", used.bytes));
+        }
+        dump_trace();
 
         // Обработка завершения игры
-        if (is_replay) return play();  // Рестарт игры
+        if (is_replay) return Replay;  // Рестарт игры
         if (is_quit) return 0;         // Выход без результата
 
         // Определение результата игры
         int res = 2;  // По умолчанию ничья (2)
-        if (turn_num == Max_turns) {
-            res = 0;  // Ничья по достижению лимита ходов
+        if (turn_num == Max_turns || is_draw) {
+            res = 0;  // Ничья по достижению лимита ходов, повторением или без прогресса
         }
         else if (turn_num % 2) {
             res = 1;  // Победа черных
@@ -114,30 +188,268 @@ class Game
         // Показ финального экрана и обработка ответа игрока
         board.show_final(res);
         auto resp = hand.wait();
-        if (resp == Response::REPLAY) {
-            is_replay = true;
-            return play();  // Рестарт по запросу игрока
-        }
+        while (resp == Response::WAKE)
+            resp = hand.wait();
+        if (resp == Response::REPLAY)
+            return Replay;  // Рестарт по запросу игрока
         return res;  // Возврат результата игры
     }
 
-  private:
-      void bot_turn(const bool color)
+    // Перечитывает settings.json, если он изменился, и пересоздает логику бота.
+    // Некорректный файл не применяется, ошибка пишется в лог
+    void reload_config()
+    {
+        string error;
+        if (config.reload_if_changed(&error)) {
+            save_cache();
+            logic = Logic(&config);
+            configure_log();
+            create_cache();
+            log_write(LogLevel::Info, LogRecord("settings_reloaded"));
+        }
+        else if (!error.empty()) {
+            log_write(LogLevel::Warning, LogRecord("settings_invalid")("error", error)("applied", false));
+        }
+    }
+
+    // Кэш поиска бота (общий для ходов и переигровок) и постоянный кэш из настроек.
+    // Пересоздаются при смене настроек: старые оценки могли быть получены с другой оценкой позиции
+    void create_cache()
+    {
+        const auto& bot = config.settings().bot;
+        tt.reset();
+        cache.reset();
+        if (bot.hash_mb > 0)
+            tt = make_unique<TranspositionTable>(size_t(bot.hash_mb));
+        if (tt && !bot.cache_file.empty())
+            cache = make_unique<SearchCache>(project_path + bot.cache_file, logic.cache_signature(), size_t(bot.cache_mb));
+        proof_table = make_unique<ProofTable>(size_t(config.settings().solver.table_mb));
+        book.reset();
+        if (!bot.book_file.empty())
+        {
+            book = make_unique<PositionDb>(project_path + bot.book_file);
+            if (!book->is_open())
+            {
+                log_write(LogLevel::Error, LogRecord("book_open_failed")("path", bot.book_file));
+                book.reset();
+            }
+        }
+    }
+
+    static int count_pieces(const vector<vector<POS_T>>& mtx)
+    {
+        int res = 0;
+        for (const auto& row : mtx)
+            res += int(count_if(row.begin(), row.end(), [](POS_T cell) { return cell != 0; }));
+        return res;
+    }
+
+    /**
+     * Ход из базы позиций: среди ходов, сыгранных не меньше чем в BookMinGames партиях,
+     * ход с лучшим средним результатом (пусто - позиции нет в базе или подходящих ходов нет).
+     * Ход проверяется по списку допустимых full_turns.
+     */
+    vector<move_pos> book_move(const vector<vector<POS_T>>& mtx, const bool color,
+                               const vector<vector<move_pos>>& full_turns) const
+    {
+        PositionDb::Stats stats;
+        if (!book || !book->probe(mtx, color, stats))
+            return {};
+        const uint32_t min_games = uint32_t(config.settings().bot.book_min_games);
+        const PositionDb::MoveStats* best = nullptr;
+        double best_score = -1;
+        for (const auto& item : stats.moves)
+        {
+            const auto& counts = item.counts;
+            if (counts.games < min_games || find(full_turns.begin(), full_turns.end(), item.turns) == full_turns.end())
+                continue;
+            const double score = (counts.wins + counts.draws * 0.5) / counts.games;
+            if (score > best_score)
+            {
+                best = &item;
+                best_score = score;
+            }
+        }
+        return best ? best->turns : vector<move_pos>{};
+    }
+
+    /**
+     * Нужно ли решать позицию решателем: мало фигур или прошлый поиск бота нашел выигрыш.
+     * После неудачи решатель не запускается, пока не изменится число фигур
+     */
+    bool use_solver(const vector<vector<POS_T>>& mtx, const bool color) const
+    {
+        const auto& solver = config.settings().solver;
+        if (!proof_table || solver.max_pieces <= 0)
+            return false;
+        const int pieces = count_pieces(mtx);
+        return (pieces <= solver.max_pieces || solver_hint[color]) && pieces < solver_failed_pieces[color];
+    }
+
+    // Слияние кэша поиска с постоянным кэшем (если он задан)
+    void save_cache()
+    {
+        if (!cache)
+            return;
+        TraceScope trace("save_cache", "game");
+        string error;
+        const long long added = cache->merge(*tt, &error);
+        if (added < 0)
+            log_write(LogLevel::Error, LogRecord("cache_save_failed")("error", error));
+        else
+            log_write(LogLevel::Info, LogRecord("cache_saved")("added", added));
+        Logger::get().flush();
+    }
+
+    // Уровень и ротация лога и включение трассировки из настроек
+    void configure_log()
+    {
+        const auto& log = config.settings().log;
+        Logger::get().configure(log.level, log.max_bytes, log.files);
+        Trace::get().enable(!log.trace_path.empty());
+    }
+
+    // Запись трассировки (если включена) в файл из настроек
+    void dump_trace()
+    {
+        const string& path = config.settings().log.trace_path;
+        if (!path.empty() && !Trace::get().dump(project_path + path))
+            log_write(LogLevel::Error, LogRecord("trace_dump_failed")("path", path));
+    }
+
+    /**
+     * Запоминает позицию в начале хода turn_num.
+     * @return true, если партия закончилась ничьей: позиция повторилась RepetitionCount раз
+     * после последнего необратимого хода или NoProgressTurns ходов подряд не было взятий и ходов простыми
+     */
+    bool add_position(const int turn_num)
+    {
+        MemScope mem(MemSubsystem::History);
+        positions.add(board.get_board(), turn_num);
+        if (engine.is_running()) {
+            boards.resize(turn_num);
+            boards.push_back(board.get_board());
+        }
+        const auto& rules = config.settings().game;
+        return positions.is_draw(rules.repetitions, rules.no_progress_turns);
+    }
+
+    /**
+     * Ход бота. Поиск идет в отдельном потоке, главный поток в это время
+     * ждет события окна (без опроса в цикле) до пробуждения из потока поиска.
+     * @return Response::QUIT, если окно закрыто во время хода, иначе Response::OK
+     */
+      Response bot_turn(const bool color, const int turn_num)
       {
+          TraceScope trace("bot_turn", "game");
           // Засекаем время начала хода бота для последующего замера производительности
           auto start = chrono::steady_clock::now();
 
           // Получаем задержку для бота из конфигурации (в миллисекундах)
-          auto delay_ms = config("Bot", "BotDelayMS");
+          const int delay_ms = config.settings().bot.delay_ms;
+
+          // Уровень сложности бота для текущего игрока
+          SearchControl control;
+          SearchParams params;
+          params.depth = config.settings().bot.level[color];
+          params.control = &control;
+          params.history = positions.since_irreversible();
+          params.tt = tt.get();
+          params.cache = cache.get();
+          if (tt)
+              tt->new_search();
+          if (timer.enabled())
+          {
+              timer.start_turn(color, turn_num, config.settings().game.max_turns);
+              control.deadline_ms = timer.deadline_ms();
+          }
+          const long long engine_movetime =
+              (timer.enabled() ? max(1ll, timer.soft_limit_ms()) : config.settings().bot.engine_movetime_ms);
 
-          // Создаем отдельный поток для задержки, чтобы основной поток мог выполнять вычисления
-          thread th(SDL_Delay, delay_ms);
+          // Единственный ход (обычно обязательное взятие) и ход из базы позиций делаются сразу, без поиска
+          const auto mtx = board.get_board();
+          const auto full_turns = logic.find_full_turns(color, mtx);
+          const bool is_forced = (full_turns.size() == 1);
 
           // Находим лучшие ходы для бота на основе текущего состояния доски и цвета фигур
-          auto turns = logic.find_best_turns(color);
+          // (во внешнем движке, если он запущен, иначе - во встроенной логике)
+          vector<move_pos> turns = (is_forced ? full_turns[0] : book_move(mtx, color, full_turns));
+          const bool by_book = !is_forced && !turns.empty();
+          const bool is_instant = is_forced || by_book;
+          SearchResult result;
+          SolveResult solved;
+          bool by_engine = false;
+          const bool by_solver = !is_instant && use_solver(mtx, color);
+          atomic<bool> is_found{ is_instant };
+          // Внешнему движку - позиции после последнего необратимого хода (для правил ничьей)
+          vector<vector<vector<POS_T>>> engine_boards;
+          if (!is_instant && engine.is_running())
+              engine_boards.assign(boards.end() - params.history.size() - 1, boards.end());
+          // Выделения памяти поиска и решателя за ход
+          const MemUsage search_memory = Memory::usage(MemSubsystem::Search);
+          const MemUsage solver_memory = Memory::usage(MemSubsystem::Solver);
+          thread search;
+          if (!is_instant)
+              search = thread([&] {
+                  if (engine.is_running()) {
+                      turns = engine.find_best_turns(engine_boards, color, params.depth, engine_movetime);
+                      // Ход движка играется, только если это один из легальных ходов позиции
+                      const auto legal = find(full_turns.begin(), full_turns.end(), turns);
+                      if (legal != full_turns.end())
+                          turns = *legal;
+                      else if (!turns.empty()) {
+                          log_write(LogLevel::Warning, LogRecord("engine_illegal_move")
+                                                           ("move", turns_to_str(turns))("fallback", "logic"));
+                          turns.clear();
+                      }
+                  }
+                  by_engine = !turns.empty();
+                  // Доказанный выигрыш играется по линии решателя, иначе - обычный поиск
+                  if (!by_engine && by_solver) {
+                      solved = Solver(&config).solve(mtx, color, params.history, *proof_table,
+                                                     config.settings().solver.max_nodes, &control);
+                      if (solved.outcome == SolveResult::Outcome::Win)
+                          turns = solved.line[0];
+                  }
+                  if (turns.empty()) {
+                      result = (timer.enabled() ? search_timed(mtx, color, params)
+                                                : logic.find_best_turns(mtx, color, params));
+                      turns = result.turns;
+                  }
+                  is_found = true;
+                  Hand::wake();
+              });
+
+          // Пока бот думает, окно продолжает обрабатывать события
+          Response resp = Response::OK;
+          TraceScope wait_trace("bot_wait", "game");
+          while (!is_found)
+          {
+              if (hand.wait() == Response::QUIT)
+              {
+                  resp = Response::QUIT;
+                  control.stop = true; // Прерываем поиск, ход не выполняется
+                  engine.interrupt();
+              }
+          }
+          if (search.joinable())
+              search.join();
+          if (resp == Response::QUIT)
+              return resp;
+          if (timer.enabled())
+              timer.end_turn(color);
+          const bool is_solved = !by_engine && solved.outcome == SolveResult::Outcome::Win;
+          if (!by_engine && !is_instant)
+          {
+              solver_hint[color] = is_solved || result.score >= INF;
+              if (by_solver && solved.outcome == SolveResult::Outcome::Unknown)
+                  solver_failed_pieces[color] = count_pieces(mtx);
+          }
 
-          // Ожидаем завершения потока с задержкой, чтобы задержка была одинаковой для каждого хода
-          th.join();
+          // Задержка хода бота: не меньше delay_ms с начала хода, чтобы она была одинаковой для каждого хода
+          const int spent_ms = int(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+          if (!pause(delay_ms - spent_ms))
+              return Response::QUIT;
 
           bool is_first = true;
 
@@ -145,10 +457,8 @@ class Game
           for (auto turn : turns)
           {
               // Добавляем задержку перед каждым ходом, кроме первого
-              if (!is_first)
-              {
-                  SDL_Delay(delay_ms);
-              }
+              if (!is_first && !pause(delay_ms))
+                  return Response::QUIT;
               is_first = false;
 
               // Увеличиваем счетчик серии ударов, если ход является ударным (xb != -1)
@@ -161,20 +471,85 @@ class Game
           // Засекаем время окончания хода бота
           auto end = chrono::steady_clock::now();
 
-          // Открываем файл лога для записи времени выполнения хода бота
-          ofstream fout(project_path + "log.txt", ios_base::app);
-          fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-          fout.close();
+          // Запись времени хода и статистики поиска в лог
+          LogRecord rec("bot_turn");
+          rec("color", color ? "black" : "white")("depth", params.depth)
+             ("time_ms", (long long)chrono::duration<double, milli>(end - start).count())
+             ("source", is_forced ? "forced" : by_book ? "book" : by_engine ? "engine" : is_solved ? "solver" : "logic")
+             ("move", turns_to_str(turns));
+          if (timer.enabled())
+              rec("budget_ms", timer.soft_limit_ms())("left_ms", timer.left(color));
+          if (by_solver && !by_engine)
+              rec("solver_nodes", (long long)solved.nodes)("solver_plies", (long long)solved.line.size())
+                 ("solver_allocs", (Memory::usage(MemSubsystem::Solver) - solver_memory).allocs);
+          if (!by_engine && !is_solved && !is_instant)
+              rec("nodes", result.nodes)("score", result.score)("futility", result.stats.futility_prunes)
+                 ("razoring", result.stats.razorings)("lmr", result.stats.lmr_reductions)
+                 ("lmr_researches", result.stats.lmr_researches)("probcut", result.stats.probcut_cuts)
+                 ("single_reply_ext", result.stats.single_reply_extensions)
+                 ("capture_ext", result.stats.capture_extensions)("quiet_reductions", result.stats.quiet_reductions);
+          if (!is_instant) {
+              const MemUsage used = Memory::usage(MemSubsystem::Search) - search_memory;
+              rec("search_allocs", used.allocs)("search_alloc_bytes", used.bytes);
+          }
+          rec("rss_kb", Memory::resident_bytes() / 1024);
+          log_write(LogLevel::Info, rec);
+          return Response::OK;
       }
 
+    /**
+     * Поиск с распределением времени: итеративное углубление до уровня бота, пока его
+     * продолжение разрешает TimeManager. params.depth - наибольшая глубина, после поиска - достигнутая
+     */
+    SearchResult search_timed(const vector<vector<POS_T>>& mtx, const bool color, SearchParams& params)
+    {
+        SearchResult res;
+        unsigned long long nodes = 0;
+        const int max_depth = params.depth;
+        SearchControl* control = params.control;
+        for (int depth = 0; depth <= max_depth; ++depth)
+        {
+            SearchParams iteration = params;
+            iteration.depth = depth;
+            // Первая итерация всегда доводится до конца, чтобы был хотя бы один ход
+            iteration.control = (depth == 0 ? nullptr : control);
+            auto found = logic.find_best_turns(mtx, color, iteration);
+            nodes += found.nodes;
+            if (found.aborted)
+                break;
+            res = move(found);
+            params.depth = depth;
+            if (res.score >= INF || res.score <= 0 || !timer.next_iteration(res.turns, res.score))
+                break;
+        }
+        res.nodes = nodes;
+        return res;
+    }
+
+    // Пауза на ms миллисекунд с обработкой событий окна, false - окно закрыто
+    bool pause(const int ms)
+    {
+        TraceScope trace("bot_delay", "game");
+        const auto end = chrono::steady_clock::now() + chrono::milliseconds(ms);
+        while (true)
+        {
+            auto left = chrono::duration_cast<chrono::milliseconds>(end - chrono::steady_clock::now()).count();
+            if (left <= 0)
+                return true;
+            if (hand.wait(int(left)) == Response::QUIT)
+                return false;
+        }
+    }
+
     // Обрабатывает ход игрока
     // Параметр color: цвет игрока (false - белые, true - черные)
+    // Параметр turns: возможные ходы игрока
     // Возвращает Response - результат выполнения хода
-    Response player_turn(const bool color)
+    Response player_turn(const bool color, const MoveList& turns)
     {
         // Подготавливаем список клеток с возможными ходами
         vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)
+        for (auto turn : turns)
         {
             cells.emplace_back(turn.x, turn.y); // Добавляем начальные позиции всех возможных ходов
         }
@@ -188,6 +563,8 @@ class Game
         {
             // Получаем от игрока выбор клетки
             auto resp = hand.get_cell();
+            if (get<0>(resp) == Response::WAKE)
+                continue; // Пробуждение без действия игрока
 
             // Если игрок выбрал не клетку (например, нажал кнопку меню)
             if (get<0>(resp) != Response::CELL)
@@ -198,7 +575,7 @@ class Game
 
             // Проверяем корректность выбора
             bool is_correct = false;
-            for (auto turn : logic.turns)
+            for (auto turn : turns)
             {
                 // Если выбрана шашка, которой можно ходить
                 if (turn.x == cell.first && turn.y == cell.second)
@@ -243,7 +620,7 @@ class Game
 
             // Подготавливаем список возможных целевых клеток для выбранной шашки
             vector<pair<POS_T, POS_T>> cells2;
-            for (auto turn : logic.turns)
+            for (auto turn : turns)
             {
                 if (turn.x == x && turn.y == y)
                 {
@@ -267,13 +644,13 @@ class Game
         while (true)
         {
             // Ищем возможные продолжения боя для текущей шашки
-            logic.find_turns(pos.x2, pos.y2);
-            if (!logic.have_beats) // Если больше бить нельзя
+            auto beats = logic.find_turns(pos.x2, pos.y2, board.get_board());
+            if (!beats.have_beats) // Если больше бить нельзя
                 break;
 
             // Подготавливаем список клеток, куда можно бить
             vector<pair<POS_T, POS_T>> cells;
-            for (auto turn : logic.turns)
+            for (auto turn : beats)
             {
                 cells.emplace_back(turn.x2, turn.y2);
             }
@@ -284,13 +661,15 @@ class Game
             while (true)
             {
                 auto resp = hand.get_cell();
+                if (get<0>(resp) == Response::WAKE)
+                    continue;
                 if (get<0>(resp) != Response::CELL)
                     return get<0>(resp);
                 pair<POS_T, POS_T> cell{ get<1>(resp), get<2>(resp) };
 
                 // Проверяем корректность выбора продолжения боя
                 bool is_correct = false;
-                for (auto turn : logic.turns)
+                for (auto turn : beats)
                 {
                     if (turn.x2 == cell.first && turn.y2 == cell.second)
                     {
@@ -319,6 +698,17 @@ class Game
     Board board;
     Hand hand;
     Logic logic;
+    unique_ptr<TranspositionTable> tt; // Кэш поиска бота (nullptr - отключен)
+    unique_ptr<SearchCache> cache;      // Постоянный кэш между запусками (nullptr - не задан)
+    unique_ptr<ProofTable> proof_table; // Таблица решателя (общая для ходов партии)
+    unique_ptr<PositionDb> book;        // База позиций для ходов без поиска (nullptr - не задана)
+    TimeManager timer;                  // Время бота на партию (BotGameTimeMS)
+    bool solver_hint[2];                // Прошлый поиск бота этого цвета нашел выигрыш
+    int solver_failed_pieces[2];        // Число фигур, при котором решатель не справился
+    EngineClient engine; // Внешний движок (если задан EnginePath)
+
+    PositionHistory positions; // Позиции в начале каждого хода партии (для правил ничьей)
+    vector<vector<vector<POS_T>>> boards; // Доски в начале каждого хода (только с внешним движком)
     int beat_series;
-    bool is_replay = false;
+    int games = 0; // Число начатых партий за запуск
 };
@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <tuple>
 
 #include "../Models/Move.h"
@@ -6,19 +7,33 @@
 #include "Board.h"
 
 // Класс для обработки пользовательского ввода (мышь, окно)
+// Ожидание событий блокирующее (SDL_WaitEvent), без опроса в цикле.
+// Другой поток может прервать ожидание вызовом Hand::wake().
 class Hand
 {
 public:
     // Конструктор, принимает указатель на игровую доску
     Hand(Board* board) : board(board) {}
 
+    // Прерывает ожидание событий в главном потоке (можно вызывать из любого потока)
+    static void wake()
+    {
+        SDL_Event event{};
+        event.type = SDL_USEREVENT;
+        event.user.code = Wake_code;
+        SDL_PushEvent(&event);
+    }
+
     // Основной метод для получения выбранной клетки от игрока
     // Возвращает кортеж из:
     // - Response (действие игрока)
     // - x-координата клетки (0-7 или -1 если не клетка)
     // - y-координата клетки (0-7 или -1 если не клетка)
-    tuple<Response, POS_T, POS_T> get_cell() const
+    // Response::WAKE - ожидание прервано вызовом wake() или истек timeout_ms (-1 - без ограничения)
+    tuple<Response, POS_T, POS_T> get_cell(const int timeout_ms = -1) const
     {
+        TraceScope trace("hand_get_cell", "input");
+        const auto deadline = make_deadline(timeout_ms);
         SDL_Event windowEvent;  // Событие SDL
         Response resp = Response::OK;  // Реакция по умолчанию
         int x = -1, y = -1;     // Абсолютные координаты курсора
@@ -26,98 +41,144 @@ public:
 
         while (true)  // Цикл обработки событий
         {
-            if (SDL_PollEvent(&windowEvent))  // Проверяем наличие события
+            if (!wait_event(windowEvent, deadline))  // Ждем событие (поток спит)
+                return { Response::WAKE, -1, -1 };
+            switch (windowEvent.type)  // Анализируем тип события
             {
-                switch (windowEvent.type)  // Анализируем тип события
+            case SDL_QUIT:  // Событие закрытия окна
+                resp = Response::QUIT;
+                break;
+
+            case SDL_USEREVENT:  // Пробуждение из другого потока
+                if (windowEvent.user.code == Wake_code)
+                    return { Response::WAKE, -1, -1 };
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:  // Клик мыши
+                x = windowEvent.motion.x;  // Получаем координаты клика
+                y = windowEvent.motion.y;
+
+                // Преобразуем в координаты клетки (0-7)
+                xc = int(y / (board->H / 10) - 1);
+                yc = int(x / (board->W / 10) - 1);
+
+                // Проверка кликов на специальных кнопках:
+                if (xc == -1 && yc == -1 && board->history_size() > 1)
                 {
-                case SDL_QUIT:  // Событие закрытия окна
-                    resp = Response::QUIT;
-                    break;
+                    resp = Response::BACK;  // Кнопка "Назад"
+                }
+                else if (xc == -1 && yc == 8)
+                {
+                    resp = Response::REPLAY;  // Кнопка "Повтор"
+                }
+                else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
+                {
+                    resp = Response::CELL;  // Клик по игровому полю
+                }
+                else
+                {
+                    xc = -1;  // Клик вне значимых областей
+                    yc = -1;
+                }
+                break;
 
-                case SDL_MOUSEBUTTONDOWN:  // Клик мыши
-                    x = windowEvent.motion.x;  // Получаем координаты клика
-                    y = windowEvent.motion.y;
-
-                    // Преобразуем в координаты клетки (0-7)
-                    xc = int(y / (board->H / 10) - 1);
-                    yc = int(x / (board->W / 10) - 1);
-
-                    // Проверка кликов на специальных кнопках:
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
-                    {
-                        resp = Response::BACK;  // Кнопка "Назад"
-                    }
-                    else if (xc == -1 && yc == 8)
-                    {
-                        resp = Response::REPLAY;  // Кнопка "Повтор"
-                    }
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
-                    {
-                        resp = Response::CELL;  // Клик по игровому полю
-                    }
-                    else
-                    {
-                        xc = -1;  // Клик вне значимых областей
-                        yc = -1;
-                    }
+            case SDL_WINDOWEVENT:  // События окна
+                if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                {
+                    board->reset_window_size();  // Обработка изменения размера
                     break;
-
-                case SDL_WINDOWEVENT:  // События окна
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
-                    {
-                        board->reset_window_size();  // Обработка изменения размера
-                        break;
-                    }
                 }
+                if (windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                    board->repaint();  // Окно снова видно
+                break;
 
-                if (resp != Response::OK)  // Если было значимое событие
-                    break;  // Выходим из цикла
+            case SDL_RENDER_TARGETS_RESET:  // Содержимое кадра потеряно
+                board->reset_window_size();
+                break;
             }
+
+            if (resp != Response::OK)  // Если было значимое событие
+                break;  // Выходим из цикла
         }
         return { resp, xc, yc };  // Возвращаем результат
     }
 
     // Метод ожидания действия пользователя (без привязки к клеткам)
     // Используется в меню и диалогах
-    Response wait() const
+    // Response::WAKE - ожидание прервано вызовом wake() или истек timeout_ms (-1 - без ограничения)
+    Response wait(const int timeout_ms = -1) const
     {
+        TraceScope trace("hand_wait", "input");
         SDL_Event windowEvent;
         Response resp = Response::OK;
+        const auto deadline = make_deadline(timeout_ms);
 
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            if (!wait_event(windowEvent, deadline))
+                return Response::WAKE;
+            switch (windowEvent.type)
             {
-                switch (windowEvent.type)
-                {
-                case SDL_QUIT:  // Закрытие окна
-                    resp = Response::QUIT;
-                    break;
+            case SDL_QUIT:  // Закрытие окна
+                resp = Response::QUIT;
+                break;
 
-                case SDL_WINDOWEVENT_SIZE_CHANGED:  // Изменение размера
+            case SDL_USEREVENT:  // Пробуждение из другого потока
+                if (windowEvent.user.code == Wake_code)
+                    resp = Response::WAKE;
+                break;
+
+            case SDL_WINDOWEVENT:  // Изменение размера или окно снова видно
+                if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
                     board->reset_window_size();
-                    break;
+                else if (windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                    board->repaint();
+                break;
 
-                case SDL_MOUSEBUTTONDOWN:  // Клик мыши
-                {
-                    int x = windowEvent.motion.x;
-                    int y = windowEvent.motion.y;
-                    // Проверяем только кнопку "Повтор" (специальная область)
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
-                    if (xc == -1 && yc == 8)
-                        resp = Response::REPLAY;
-                }
+            case SDL_RENDER_TARGETS_RESET:  // Содержимое кадра потеряно
+                board->reset_window_size();
                 break;
-                }
 
-                if (resp != Response::OK)
-                    break;
+            case SDL_MOUSEBUTTONDOWN:  // Клик мыши
+            {
+                int x = windowEvent.motion.x;
+                int y = windowEvent.motion.y;
+                // Проверяем только кнопку "Повтор" (специальная область)
+                int xc = int(y / (board->H / 10) - 1);
+                int yc = int(x / (board->W / 10) - 1);
+                if (xc == -1 && yc == 8)
+                    resp = Response::REPLAY;
             }
+            break;
+            }
+
+            if (resp != Response::OK)
+                break;
         }
         return resp;
     }
 
 private:
+    using time_point = chrono::steady_clock::time_point;
+
+    // Момент окончания ожидания (time_point::max() - без ограничения)
+    static time_point make_deadline(const int timeout_ms)
+    {
+        if (timeout_ms < 0)
+            return time_point::max();
+        return chrono::steady_clock::now() + chrono::milliseconds(timeout_ms);
+    }
+
+    // Ожидание следующего события до deadline, false - время истекло
+    static bool wait_event(SDL_Event& event, const time_point deadline)
+    {
+        if (deadline == time_point::max())
+            return SDL_WaitEvent(&event) == 1;
+        auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+        return left > 0 && SDL_WaitEventTimeout(&event, int(left)) == 1;
+    }
+
+private:
+    static constexpr Sint32 Wake_code = 1; // Код пользовательского события пробуждения
     Board* board;  // Указатель на игровую доску для взаимодействия
 };
\ No newline at end of file
@@ -0,0 +1,354 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../Models/Project_path.h"
+#include "Memory.h"
+
+using namespace std;
+
+// Уровень важности записи лога
+enum class LogLevel
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+/**
+ * Запись лога в формате key=value. Собирается в буфере фиксированного размера
+ * без выделения памяти, слишком длинная запись обрезается и заканчивается на " ..."
+ * (полная запись хода бота O2 со статистикой поиска и памяти - около 400 символов).
+ * Пример: LogRecord("bot_turn")("time_ms", 12)("nodes", 3481)
+ */
+class LogRecord
+{
+public:
+    static constexpr size_t Capacity = 480; // Вместе с заголовком слот лога занимает 512 байт
+
+    explicit LogRecord(const char *event)
+    {
+        append("event=");
+        append(event);
+    }
+
+    LogRecord &operator()(const char *key, const char *value)
+    {
+        add_key(key);
+        // Значения с пробелами берутся в кавычки
+        if (strchr(value, ' '))
+        {
+            append("\"");
+            append(value);
+            append("\"");
+        }
+        else
+            append(value);
+        return *this;
+    }
+
+    LogRecord &operator()(const char *key, const string &value)
+    {
+        return (*this)(key, value.c_str());
+    }
+
+    LogRecord &operator()(const char *key, const bool value)
+    {
+        return (*this)(key, value ? "true" : "false");
+    }
+
+    LogRecord &operator()(const char *key, const double value)
+    {
+        add_key(key);
+        char buf[32];
+        int n = snprintf(buf, sizeof(buf), "%.4f", value);
+        append(buf, size_t(max(n, 0)));
+        return *this;
+    }
+
+    template <class T> LogRecord &operator()(const char *key, const T value)
+    {
+        add_key(key);
+        char buf[24];
+        auto res = to_chars(buf, buf + sizeof(buf), value);
+        append(buf, size_t(res.ptr - buf));
+        return *this;
+    }
+
+    const char *data() const
+    {
+        return text.data();
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+private:
+    void add_key(const char *key)
+    {
+        append(" ");
+        append(key);
+        append("=");
+    }
+
+    void append(const char *s)
+    {
+        append(s, strlen(s));
+    }
+
+    void append(const char *s, size_t n)
+    {
+        if (length == Capacity)
+            return; // Запись уже обрезана
+        if (n > Capacity - Truncated_size - length)
+        {
+            // Не помещается: текст до предела и пометка обрезки
+            n = min(n, Capacity - Truncated_size - length);
+            memcpy(text.data() + length, s, n);
+            memcpy(text.data() + length + n, Truncated, Truncated_size);
+            length = Capacity;
+            return;
+        }
+        memcpy(text.data() + length, s, n);
+        length += n;
+    }
+
+    static constexpr const char *Truncated = " ...";
+    static constexpr size_t Truncated_size = 4;
+
+private:
+    array<char, Capacity> text;
+    size_t length = 0;
+};
+
+/**
+ * Асинхронный лог в файл (log.txt в папке проекта).
+ * Игровой поток только копирует запись в кольцевой буфер без блокировок (несколько писателей,
+ * один читатель), запись в файл и ротацию по размеру выполняет фоновый поток.
+ * Если буфер переполнен, запись отбрасывается (число потерянных записей попадает в лог).
+ * Формат строки: "<время от запуска в мс> level=<уровень> event=<событие> key=value ...".
+ */
+class Logger
+{
+public:
+    // Общий лог процесса
+    static Logger &get()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    /**
+     * Настройка лога, при первом вызове файл очищается и запускается фоновый поток.
+     * @param min_level Записи ниже этого уровня отбрасываются сразу в вызывающем потоке
+     * @param max_bytes Размер файла, после которого он переименовывается в log.1.txt (0 - без ротации)
+     * @param max_files Сколько старых файлов хранить (log.1.txt ... log.<max_files>.txt)
+     */
+    void configure(const LogLevel min_level, const size_t max_bytes, const int max_files)
+    {
+        level = min_level;
+        rotate_bytes = max_bytes;
+        rotate_files = max_files;
+        if (!flusher.joinable())
+        {
+            fout.open(path(0), ios_base::trunc);
+            flusher = thread(&Logger::run, this);
+        }
+    }
+
+    bool enabled(const LogLevel record_level) const
+    {
+        return record_level >= level.load(memory_order_relaxed);
+    }
+
+    // Добавление записи (без блокировок и системных вызовов)
+    void write(const LogLevel record_level, const LogRecord &record)
+    {
+        if (!enabled(record_level))
+            return;
+        MemScope mem(MemSubsystem::Log);
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        Slot *slot;
+        while (true)
+        {
+            slot = &slots[pos % Slots_count];
+            size_t seq = slot->seq.load(memory_order_acquire);
+            if (seq == pos)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (seq < pos)
+            {
+                dropped.fetch_add(1, memory_order_relaxed); // Буфер полон
+                return;
+            }
+            else
+                pos = enqueue_pos.load(memory_order_relaxed);
+        }
+        slot->level = record_level;
+        slot->time_us = now_us();
+        slot->length = uint16_t(record.size());
+        memcpy(slot->text.data(), record.data(), record.size());
+        slot->seq.store(pos + 1, memory_order_release);
+        if (is_idle.load(memory_order_relaxed))
+            wake_cv.notify_one();
+    }
+
+    // Дописывает все накопленные записи в файл (блокирующий вызов)
+    void flush()
+    {
+        lock_guard<mutex> lock(file_mutex);
+        drain();
+    }
+
+    ~Logger()
+    {
+        is_stopped = true;
+        wake_cv.notify_one();
+        if (flusher.joinable())
+            flusher.join();
+    }
+
+private:
+    struct Slot
+    {
+        atomic<size_t> seq{0};
+        LogLevel level = LogLevel::Info;
+        long long time_us = 0;
+        uint16_t length = 0;
+        array<char, LogRecord::Capacity> text;
+    };
+
+    Logger() : start(chrono::steady_clock::now())
+    {
+        for (size_t k = 0; k < Slots_count; ++k)
+            slots[k].seq.store(k, memory_order_relaxed);
+    }
+
+    static string path(const int index)
+    {
+        return project_path + (index ? "log." + to_string(index) + ".txt" : "log.txt");
+    }
+
+    // Фоновый поток: ждет записи и пишет их пачками
+    void run()
+    {
+        while (!is_stopped)
+        {
+            {
+                lock_guard<mutex> lock(file_mutex);
+                if (drain())
+                    continue;
+            }
+            unique_lock<mutex> lock(wake_mutex);
+            is_idle = true;
+            wake_cv.wait_for(lock, chrono::milliseconds(200));
+            is_idle = false;
+        }
+        lock_guard<mutex> lock(file_mutex);
+        drain();
+    }
+
+    // Запись готовых записей в файл (под file_mutex), false - записей не было
+    bool drain()
+    {
+        bool is_written = false;
+        while (true)
+        {
+            Slot &slot = slots[dequeue_pos % Slots_count];
+            if (slot.seq.load(memory_order_acquire) != dequeue_pos + 1)
+                break;
+            write_line(slot.level, slot.time_us, slot.text.data(), slot.length);
+            slot.seq.store(dequeue_pos + Slots_count, memory_order_release);
+            ++dequeue_pos;
+            is_written = true;
+        }
+        if (size_t lost = dropped.exchange(0, memory_order_relaxed))
+        {
+            // Запись о потерях - в том же формате, что и остальные
+            LogRecord record("log_overflow");
+            record("dropped", lost);
+            write_line(LogLevel::Warning, now_us(), record.data(), record.size());
+            is_written = true;
+        }
+        if (is_written)
+        {
+            fout.flush();
+            if (rotate_bytes && written >= rotate_bytes)
+                rotate();
+        }
+        return is_written;
+    }
+
+    // Строка файла: время, уровень и текст записи
+    void write_line(const LogLevel record_level, const long long time_us, const char *text, const size_t length)
+    {
+        static const char *names[] = {"debug", "info", "warning", "error"};
+        char prefix[64];
+        int n = snprintf(prefix, sizeof(prefix), "%lld.%03lld level=%s ", time_us / 1000, time_us % 1000,
+                         names[int(record_level)]);
+        fout.write(prefix, n);
+        fout.write(text, length);
+        fout.put('\n');
+        written += size_t(n) + length + 1;
+    }
+
+    long long now_us() const
+    {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Ротация: log.txt -> log.1.txt -> ... -> log.<rotate_files>.txt (самый старый удаляется)
+    void rotate()
+    {
+        fout.close();
+        const int files = rotate_files;
+        remove(path(files).c_str());
+        for (int k = files - 1; k >= 0; --k)
+            rename(path(k).c_str(), path(k + 1).c_str());
+        fout.open(path(0), ios_base::trunc);
+        written = 0;
+    }
+
+private:
+    static constexpr size_t Slots_count = 4096; // Емкость кольцевого буфера (записей)
+
+    const chrono::steady_clock::time_point start;
+    array<Slot, Slots_count> slots;
+    atomic<size_t> enqueue_pos{0};
+    size_t dequeue_pos = 0;
+    atomic<size_t> dropped{0};
+
+    atomic<LogLevel> level{LogLevel::Info};
+    atomic<size_t> rotate_bytes{0};
+    atomic<int> rotate_files{0};
+
+    mutex file_mutex; // Файл пишет фоновый поток или flush()
+    ofstream fout;
+    size_t written = 0;
+
+    thread flusher;
+    mutex wake_mutex;
+    condition_variable wake_cv;
+    atomic<bool> is_idle{false};
+    atomic<bool> is_stopped{false};
+};
+
+// Короткая запись в общий лог: log_write(LogLevel::Info, LogRecord("event")("key", value))
+inline void log_write(const LogLevel level, const LogRecord &record)
+{
+    Logger::get().write(level, record);
+}
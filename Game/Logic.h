@@ -1,66 +1,211 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <random>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/MoveList.h"
+#include "../Models/Zobrist.h"
 #include "Config.h"
+#include "Memory.h"
+#include "Trace.h"
+#include "SearchCache.h"
+#include "TranspositionTable.h"
 
 const int INF = 1e9; // Константа для представления "бесконечности" в алгоритме
+const double DRAW = 1; // Оценка ничьей (равенство сил)
 
 /**
- * Класс Logic реализует игровую логику и ИИ для шашек.
+ * Внешнее управление поиском (используется движком, работающим в отдельном потоке).
+ * stop - немедленная остановка поиска
+ * deadline_ms - момент (в мс steady_clock), после которого поиск прерывается
+ */
+struct SearchControl
+{
+    atomic<bool> stop{false};
+    atomic<long long> deadline_ms{LLONG_MAX};
+
+    // Текущее время в мс по steady_clock
+    static long long now_ms()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Параметры одного поиска
+struct SearchParams
+{
+    int depth = 0;                     // Глубина анализа (уровень бота)
+    SearchControl* control = nullptr;  // Внешнее управление поиском (nullptr - без ограничений)
+    // Хеши позиций партии после последнего необратимого хода (взятия или хода простой шашки),
+    // без текущей позиции. Нужны поиску для обнаружения повторений.
+    vector<uint64_t> history;
+    int multi_pv = 1;                  // Сколько лучших ходов корня оценивать точно (Multi-PV)
+    TranspositionTable* tt = nullptr;  // Кэш поиска, общий для итераций и линий (nullptr - без кэша)
+    const SearchCache* cache = nullptr; // Постоянный кэш прошлых сессий (только чтение, nullptr - нет)
+};
+
+// Статистика выборочного поиска O2
+struct SearchStats
+{
+    unsigned long long futility_prunes = 0; // Узлы, отброшенные futility pruning
+    unsigned long long razorings = 0;       // Узлы, сокращенные razoring
+    unsigned long long lmr_reductions = 0;  // Ходы, сокращенные LMR
+    unsigned long long lmr_researches = 0;  // Пересчеты сокращенных ходов на полную глубину
+    unsigned long long probcut_cuts = 0;    // Отсечения ProbCut
+    unsigned long long single_reply_extensions = 0; // Продления позиций с единственным ходом
+    unsigned long long capture_extensions = 0;      // Продления за взятые фигуры
+    unsigned long long quiet_reductions = 0;        // Тихие ходы, сокращенные из-за оценки хуже окна
+
+    SearchStats& operator+=(const SearchStats& other)
+    {
+        futility_prunes += other.futility_prunes;
+        razorings += other.razorings;
+        lmr_reductions += other.lmr_reductions;
+        lmr_researches += other.lmr_researches;
+        probcut_cuts += other.probcut_cuts;
+        single_reply_extensions += other.single_reply_extensions;
+        capture_extensions += other.capture_extensions;
+        quiet_reductions += other.quiet_reductions;
+        return *this;
+    }
+};
+
+// Линия анализа: ход корня, за ним ожидаемое продолжение (каждый элемент - ход одной стороны)
+struct SearchLine
+{
+    vector<vector<move_pos>> turns;
+    double score = 0;
+};
+
+// Результат одного поиска
+struct SearchResult
+{
+    vector<move_pos> turns;        // Серия ходов одной фигуры (может быть неполной, если поиск прерван)
+    double score = 0;              // Оценка лучшего хода
+    vector<SearchLine> lines;      // Лучшие линии по убыванию оценки (не больше multi_pv, первая - turns)
+    unsigned long long nodes = 0;  // Число просмотренных узлов
+    bool aborted = false;          // Был ли поиск прерван
+    SearchStats stats;             // Статистика выборочного поиска
+};
+
+/**
+ * Класс BasicLogic реализует игровую логику и ИИ для шашек.
  * Отвечает за:
  * - Поиск возможных ходов
  * - Оценку позиций
  * - Принятие решений для бота
+ * После создания объект не изменяется: все методы const и могут вызываться
+ * из разных потоков одновременно (состояние поиска хранится в SearchState).
+ * Variant - вариант правил с геометрией доски (RussianDraughts, InternationalDraughts):
+ * размер доски, лучи ходов и правила взятия подставляются при компиляции.
  */
-
-class Logic
+template <class Variant>
+class BasicLogic
 {
 public:
+    using Moves = BasicMoveList<Variant::Move_capacity>; // Список ходов позиции
+
+
     /**
-     * Инициализирует логику игры с привязкой к доске и настройкам.
-     * @param board Указатель на игровое поле
+     * Инициализирует логику игры по настройкам.
      * @param config Указатель на конфигурацию игры
      */
 
-    Logic(Board* board, Config* config) : board(board), config(config)
+    BasicLogic(const Config* config)
     {
-        // Инициализация генератора случайных чисел (если не отключено в конфиге)
-        rand_eng = std::default_random_engine(
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
+        const Settings& settings = config->settings();
+        // Случайность ботов (если не отключена в конфиге)
+        no_random = settings.bot.no_random;
         // Загрузка настроек бота из конфигурации
-        scoring_mode = (*config)("Bot", "BotScoringType");
-        optimization = (*config)("Bot", "Optimization");
+        scoring_mode = settings.bot.scoring;
+        optimization = settings.bot.optimization;
+        no_progress_limit = settings.game.no_progress_turns;
+        // Приемы выборочного поиска O2 (включаются по отдельности)
+        use_lmr_setting = settings.selective.late_move_reductions;
+        use_futility = settings.selective.futility;
+        use_razoring = settings.selective.razoring;
+        use_probcut = settings.selective.probcut;
+        single_reply_extension = settings.selective.single_reply_extension;
+        capture_extension = settings.selective.capture_extension;
+        quiet_reduction = settings.selective.quiet_reduction;
+        arena_bytes = size_t(settings.bot.arena_mb) << 20;
     }
 
 
     /**
-     * Находит оптимальные ходы для заданного цвета.
+     * Находит оптимальные ходы для заданной позиции.
+     * @param mtx Состояние доски
      * @param color Цвет фигур бота (false - белые, true - черные)
-     * @return Вектор лучших ходов
+     * @param params Параметры поиска (глубина, внешнее управление)
+     * @return Лучшая серия ходов, ее оценка и статистика поиска
      */
-    vector<move_pos> find_best_turns(const bool color)
-    {
-        next_best_state.clear();
-        next_move.clear();
-
-        // Рекурсивный поиск лучшего хода
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
-        
-        // Сборка последовательности ходов из состояний
-        int cur_state = 0;
-        vector<move_pos> res;
-        do
-        {
-            res.push_back(next_move[cur_state]);
-            cur_state = next_best_state[cur_state];
-        } while (cur_state != -1 && next_move[cur_state].x != -1);
-        return res;
+    SearchResult find_best_turns(const vector<vector<POS_T>>& mtx, const bool color, const SearchParams& params) const
+    {
+        MemScope mem(MemSubsystem::Search);
+        if (!arena_bytes)
+            return search_root(mtx, color, params);
+        // Временная память поиска берется из арены потока, результат копируется в обычную кучу
+        SearchArena arena(arena_bytes);
+        const SearchResult res = search_root(mtx, color, params);
+        arena.release();
+        return SearchResult(res);
     }
 
 private:
+    SearchResult search_root(const vector<vector<POS_T>>& mtx, const bool color, const SearchParams& params) const
+    {
+        TraceScope trace("find_best_turns", "search");
+        SearchState st(params, no_random ? 0 : random_device{}());
+
+        SearchResult res;
+        if (params.multi_pv > 1)
+        {
+            // Несколько лучших ходов корня с точными оценками
+            res.lines = find_best_lines(st, mtx, color, size_t(params.multi_pv));
+            res.score = -1;
+            if (!res.lines.empty())
+            {
+                res.turns = res.lines[0].turns[0];
+                res.score = res.lines[0].score;
+            }
+        }
+        else
+        {
+            // Рекурсивный поиск лучшего хода
+            res.score = find_first_best_turn(st, mtx, color, -1, -1, 0);
+
+            // Сборка последовательности ходов из состояний
+            int cur_state = 0;
+            do
+            {
+                res.turns.push_back(st.next_move[cur_state]);
+                cur_state = st.next_best_state[cur_state];
+            } while (cur_state != -1 && st.next_move[cur_state].x != -1);
+            res.lines.push_back(SearchLine{{res.turns}, res.score});
+        }
+        res.nodes = st.nodes;
+        trace.arg("nodes", (long long)st.nodes);
+        res.aborted = st.aborted;
+        res.stats = st.stats;
+
+        // Продолжения линий берутся из кэша поиска
+        if ((st.tt || st.cache) && !st.aborted)
+        {
+            for (auto& line : res.lines)
+            {
+                auto rest = cached_line(st, make_turns(mtx, line.turns[0]), 1 - color, st.Max_depth);
+                line.turns.insert(line.turns.end(), rest.begin(), rest.end());
+            }
+        }
+        return res;
+    }
+
+public:
+
     /**
      * Применяет ход к копии доски без изменения оригинала.
      * @param mtx Текущее состояние доски
@@ -70,9 +215,10 @@ private:
     vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
     {
         if (turn.xb != -1) // Если ход включает взятие фигуры
-            mtx[turn.xb][turn.yb] = 0; // Удаляем взятую фигуру
-        // Проверка на превращение в дамку
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
+            mtx[turn.xb][turn.yb] = (Variant::Turkish_strike ? Captured_piece : 0); // Удаляем (или помечаем) взятую фигуру
+        // Проверка на превращение в дамку (по международным правилам - только в конце серии взятий, см. end_capture)
+        if ((Variant::Promote_in_capture || turn.xb == -1) &&
+            ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == Variant::Size - 1)))
             mtx[turn.x][turn.y] += 2;
         // Перемещение фигуры
         mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
@@ -80,6 +226,150 @@ private:
         return mtx;
     }
 
+    // Применяет полный ход (серию ходов одной фигуры) к копии доски
+    vector<vector<POS_T>> make_turns(vector<vector<POS_T>> mtx, const vector<move_pos>& turns) const
+    {
+        for (auto turn : turns)
+            mtx = make_turn(mtx, turn);
+        if (!turns.empty() && turns.back().xb != -1)
+            end_capture(mtx, turns.back().x2, turns.back().y2);
+        return mtx;
+    }
+
+    /**
+     * Подпись настроек, от которых зависят оценки поиска. Постоянный кэш с другой подписью
+     * (другая оценка позиции, оптимизация или правило ничьей) не используется.
+     */
+    uint64_t cache_signature() const
+    {
+        uint64_t res = uint64_t(scoring_mode) | uint64_t(optimization) << 4 | uint64_t(use_lmr_setting) << 8 |
+                       uint64_t(use_futility) << 9 | uint64_t(use_razoring) << 10 | uint64_t(use_probcut) << 11;
+        res |= uint64_t(single_reply_extension) << 12 | uint64_t(capture_extension) << 16 |
+               uint64_t(quiet_reduction) << 20;
+        return res | uint64_t(no_progress_limit) << 24 | uint64_t(Cache_format) << 56;
+    }
+
+private:
+    // Изменяемое состояние одного поиска
+    struct SearchState
+    {
+        SearchState(const SearchParams& params, const unsigned seed)
+            : Max_depth(params.depth), control(params.control), tt(params.tt), cache(params.cache), rand_eng(seed),
+              path(params.history),
+              no_progress(params.history.size())
+        {
+            path.reserve(path.size() + 4 * Max_depth + 16);
+        }
+
+        const size_t Max_depth;          // Глубина анализа
+        SearchControl* const control;    // Внешнее управление поиском
+        TranspositionTable* const tt;    // Кэш поиска (nullptr - без кэша)
+        const SearchCache* const cache;  // Постоянный кэш (nullptr - нет)
+        default_random_engine rand_eng;  // ГСЧ для перемешивания ходов
+        vector<move_pos> next_move;      // Последовательность ходов
+        vector<int> next_best_state;     // Состояния ИИ
+        unsigned long long nodes = 0;    // Число узлов
+        bool aborted = false;            // Поиск прерван
+        vector<uint64_t> path;           // Хеши позиций перед обратимыми ходами (партия + текущая ветка)
+        size_t no_progress;              // Число обратимых ходов подряд (последние записи path)
+        int reduction = 0;               // Сокращение глубины ветки в долях хода Ply (продления - со знаком минус)
+        int extension = 0;               // Сумма продлений ветки (не больше половины Max_depth ходов)
+        SearchStats stats;               // Статистика выборочного поиска
+        unsigned long long history_draws = 0; // Число ничьих повторением и без прогресса (зависят от пути)
+    };
+
+    // Ничья в узле: позиция повторилась после последнего необратимого хода
+    // или слишком долго нет взятий и ходов простыми шашками
+    bool is_draw(const SearchState& st, const vector<vector<POS_T>>& mtx, const bool color) const
+    {
+        if (st.no_progress == 0)
+            return false;
+        if (st.no_progress >= no_progress_limit)
+            return true;
+        const uint64_t hash = Zobrist::hash(mtx, color);
+        for (size_t k = 1; k <= st.no_progress && k <= st.path.size(); ++k)
+        {
+            if (st.path[st.path.size() - k] == hash)
+                return true;
+        }
+        return false;
+    }
+
+    // Поиск после хода turn: тихий ход дамки обратим (позиция до него запоминается в path),
+    // взятие и ход простой шашки обнуляют счетчик. search - продолжение поиска из новой позиции
+    template <class F>
+    double search_after(SearchState& st, const vector<vector<POS_T>>& mtx, const bool color, const move_pos& turn,
+        F search) const
+    {
+        const size_t no_progress = st.no_progress;
+        const bool reversible = (turn.xb == -1 && mtx[turn.x][turn.y] > 2);
+        if (reversible)
+        {
+            st.path.push_back(Zobrist::hash(mtx, color));
+            ++st.no_progress;
+        }
+        else
+            st.no_progress = 0;
+        double score = search(make_turn(mtx, turn));
+        if (reversible)
+            st.path.pop_back();
+        st.no_progress = no_progress;
+        return score;
+    }
+
+    // Продление ветки на units долей хода в пределах общего запаса (половина Max_depth), возвращает продление
+    static int extend(SearchState& st, const int units)
+    {
+        const int res = max(0, min(units, int(st.Max_depth) * Ply / 2 - st.extension));
+        st.extension += res;
+        return res;
+    }
+
+    // Проверка внешней остановки поиска (раз в 1024 узла, чтобы не тратить время на часы)
+    static bool check_abort(SearchState& st)
+    {
+        ++st.nodes;
+        if (!st.aborted && st.control && (st.nodes & 1023) == 0)
+            st.aborted = st.control->stop || SearchControl::now_ms() >= st.control->deadline_ms;
+        return st.aborted;
+    }
+
+    // Ключ узла в кэше поиска: позиция с очередью хода, тип узла (от него зависит, для какого цвета
+    // считается оценка) и фигура, продолжающая серию взятий
+    static uint64_t node_key(const vector<vector<POS_T>>& mtx, const bool color, const bool is_max, const POS_T x,
+        const POS_T y)
+    {
+        uint64_t key = Zobrist::hash(mtx, color);
+        if (is_max)
+            key ^= 0x8F1BBCDCCA62C1D6ull;
+        if (x != -1)
+            key ^= uint64_t(x * Variant::Size + y + 1) * 0x9E3779B97F4A7C15ull;
+        return key;
+    }
+
+    // Запись узла в кэше поиска, при промахе - в постоянном кэше
+    static const TranspositionTable::Entry* probe_cache(const SearchState& st, const uint64_t key)
+    {
+        const TranspositionTable::Entry* entry = (st.tt ? st.tt->probe(key) : nullptr);
+        return (!entry && st.cache) ? st.cache->probe(key) : entry;
+    }
+
+    // Перенос хода turn в начало списка (остальные сдвигаются), возвращает его прежний номер
+    static size_t move_to_front(Moves& turns, const move_pos& turn)
+    {
+        for (size_t k = 0; k < turns.size(); ++k)
+        {
+            if (turns[k] == turn && turns[k].xb == turn.xb && turns[k].yb == turn.yb)
+            {
+                for (size_t i = k; i > 0; --i)
+                    turns[i] = turns[i - 1];
+                turns[0] = turn;
+                return k;
+            }
+        }
+        return turns.size();
+    }
+
 
     /**
      * Вычисляет оценку позиции для заданного цвета.
@@ -92,20 +382,19 @@ private:
     {
         // Подсчет количества фигур каждого типа
         double w = 0, wq = 0, b = 0, bq = 0;
-        for (POS_T i = 0; i < 8; ++i)
+        // Перебор игровых клеток доски
+        for (const auto cell : Variant::tables.cell)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            const POS_T i = cell.x, piece = mtx[i][cell.y];
+            w += (piece == 1); // Белые простые
+            wq += (piece == 3); // Белые дамки
+            b += (piece == 2); // Черные простые
+            bq += (piece == 4); // Черные дамки
+            // Дополнительная оценка потенциала фигур
+            if (scoring_mode == ScoringType::NumberAndPotential)
             {
-                w += (mtx[i][j] == 1); // Белые простые
-                wq += (mtx[i][j] == 3); // Белые дамки
-                b += (mtx[i][j] == 2); // Черные простые
-                bq += (mtx[i][j] == 4); // Черные дамки
-                // Дополнительная оценка потенциала фигур
-                if (scoring_mode == "NumberAndPotential")
-                {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i); // Белые ближе к дамочному полю
-                    b += 0.05 * (mtx[i][j] == 2) * (i); // Черные ближе к дамочному полю
-                }
+                w += 0.05 * (piece == 1) * (Variant::Size - 1 - i); // Белые ближе к дамочному полю
+                b += 0.05 * (piece == 2) * (i); // Черные ближе к дамочному полю
             }
         }
         // Корректировка оценки в зависимости от цвета бота
@@ -120,7 +409,7 @@ private:
 
         // Коэффициенты для дамок
         int q_coef = 4;
-        if (scoring_mode == "NumberAndPotential")
+        if (scoring_mode == ScoringType::NumberAndPotential)
         {
             q_coef = 5;
         }
@@ -129,260 +418,691 @@ private:
     }
 
     // Рекурсивный поиск лучшего хода (основная логика)
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state,
-        double alpha = -1)
+    double find_first_best_turn(SearchState& st, vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y,
+        size_t state, double alpha = -1) const
     {
-        next_best_state.push_back(-1);
-        next_move.emplace_back(-1, -1, -1, -1);
+        st.next_best_state.push_back(-1);
+        st.next_move.emplace_back(-1, -1, -1, -1);
         double best_score = -1;
+        if (check_abort(st))
+            return best_score;
+        Moves turns_now; // Ходы этого уровня (на стеке)
         if (state != 0)
-            find_turns(x, y, mtx);
-        auto turns_now = turns;
-        bool have_beats_now = have_beats;
+            find_turns(x, y, mtx, turns_now);
+        else
+            find_turns(st, color, mtx, turns_now);
 
         // Если нет взятий и это не начальное состояние, переходим к рекурсивному поиску
-        if (!have_beats_now && state != 0)
+        if (!turns_now.have_beats && state != 0)
         {
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+            end_capture(mtx, x, y);
+            return find_best_turns_rec(st, mtx, 1 - color, 0, alpha);
         }
 
-        vector<move_pos> best_moves;
-        vector<int> best_states;
-
         // Перебор всех возможных ходов
         for (auto turn : turns_now)
         {
-            size_t next_state = next_move.size();
+            size_t next_state = st.next_move.size();
             double score;
-            if (have_beats_now)
+            if (turns_now.have_beats)
             {
                 // Продолжаем серию взятий
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, next_state, best_score);
+                score = search_after(st, mtx, color, turn, [&](vector<vector<POS_T>> next) {
+                    return find_first_best_turn(st, move(next), color, turn.x2, turn.y2, next_state, best_score);
+                });
             }
             else
             {
                 // Обычный ход
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+                score = search_after(st, mtx, color, turn, [&](vector<vector<POS_T>> next) {
+                    return find_best_turns_rec(st, move(next), 1 - color, 0, best_score);
+                });
             }
             // Обновление лучшего хода
             if (score > best_score)
             {
                 best_score = score;
-                next_best_state[state] = (have_beats_now ? int(next_state) : -1);
-                next_move[state] = turn;
+                st.next_best_state[state] = (turns_now.have_beats ? int(next_state) : -1);
+                st.next_move[state] = turn;
             }
         }
         return best_score;
     }
 
-    // Рекурсивный поиск с альфа-бета отсечением
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1,
-        double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
+    /**
+     * Multi-PV: оценка всех полных ходов корня (серии взятий до конца). Нижняя граница окна -
+     * оценка count-го из уже найденных лучших ходов, поэтому ходы вне лучших отсекаются
+     * так же, как в обычном поиске, а общие позиции линий берутся из кэша поиска.
+     * @return Не больше count линий (только ход корня) по убыванию оценки
+     */
+    vector<SearchLine> find_best_lines(SearchState& st, const vector<vector<POS_T>>& mtx, const bool color,
+        const size_t count) const
+    {
+        auto chains = find_full_turns(color, mtx);
+        shuffle(chains.begin(), chains.end(), st.rand_eng);
+
+        vector<SearchLine> lines;
+        for (const auto& chain : chains)
+        {
+            const double alpha = (lines.size() >= count ? lines[count - 1].score : -1);
+            const double score = search_chain(st, mtx, color, chain, alpha);
+            if (st.aborted)
+                break;
+            if (score <= alpha)
+                continue;
+            // При равной оценке выше остается линия, найденная раньше
+            auto pos = find_if(lines.begin(), lines.end(), [score](const SearchLine& line) { return line.score < score; });
+            lines.insert(pos, SearchLine{{chain}, score});
+            if (lines.size() > count)
+                lines.pop_back();
+        }
+        return lines;
+    }
+
+    // Все продолжения серии взятий chain до конца (mtx - доска после последнего взятия)
+    void add_chains(const vector<vector<POS_T>>& mtx, vector<move_pos>& chain, vector<vector<move_pos>>& res) const
+    {
+        Moves turns_now;
+        find_turns(chain.back().x2, chain.back().y2, mtx, turns_now);
+        if (!turns_now.have_beats)
+        {
+            res.push_back(chain);
+            return;
+        }
+        for (auto turn : turns_now)
+        {
+            chain.push_back(turn);
+            add_chains(make_turn(mtx, turn), chain, res);
+            chain.pop_back();
+        }
+    }
+
+    // Оценка полного хода корня chain с нижней границей alpha
+    double search_chain(SearchState& st, const vector<vector<POS_T>>& mtx, const bool color,
+        const vector<move_pos>& chain, const double alpha) const
+    {
+        if (chain.size() == 1)
+        {
+            return search_after(st, mtx, color, chain[0], [&](vector<vector<POS_T>> next) {
+                return find_best_turns_rec(st, move(next), 1 - color, 0, alpha);
+            });
+        }
+        // Серия взятий необратима
+        const size_t no_progress = st.no_progress;
+        st.no_progress = 0;
+        const double score = find_best_turns_rec(st, make_turns(mtx, chain), 1 - color, 0, alpha);
+        st.no_progress = no_progress;
+        return score;
+    }
+
+    /**
+     * Ожидаемое продолжение из кэша поиска: по лучшим ходам записей, пока они есть и легальны.
+     * @param mtx Позиция после хода корня, color - кто в ней ходит
+     * @param plies Наибольшее число ходов продолжения
+     */
+    vector<vector<move_pos>> cached_line(const SearchState& st, vector<vector<POS_T>> mtx, bool color,
+        const size_t plies) const
+    {
+        vector<vector<move_pos>> res;
+        vector<move_pos> series;
+        size_t depth = 0;
+        POS_T x = -1, y = -1;
+        while (depth < plies)
+        {
+            const auto* entry = probe_cache(st, node_key(mtx, color, depth % 2, x, y));
+            if (!entry || entry->turn.x == -1)
+                break;
+            Moves legal = (x == -1 ? find_turns(color, mtx) : find_turns(x, y, mtx));
+            if (move_to_front(legal, entry->turn) == legal.size())
+                break;
+            const move_pos turn = entry->turn;
+            mtx = make_turn(mtx, turn);
+            series.push_back(turn);
+            if (turn.xb != -1 && find_turns(turn.x2, turn.y2, mtx).have_beats)
+            {
+                x = turn.x2;
+                y = turn.y2;
+                continue;
+            }
+            if (turn.xb != -1)
+                end_capture(mtx, turn.x2, turn.y2);
+            res.push_back(series);
+            series.clear();
+            color = !color;
+            ++depth;
+            x = y = -1;
+        }
+        return res;
+    }
+
+    // Вход в рекурсивный поиск: выбор специализации по очереди хода и типу узла
+    double find_best_turns_rec(SearchState& st, vector<vector<POS_T>> mtx, const bool color, const size_t depth,
+        const double alpha = -1, const double beta = INF + 1) const
+    {
+        if (color)
+            return depth % 2 ? find_best_turns_rec<true, true>(st, move(mtx), depth, alpha, beta)
+                             : find_best_turns_rec<true, false>(st, move(mtx), depth, alpha, beta);
+        return depth % 2 ? find_best_turns_rec<false, true>(st, move(mtx), depth, alpha, beta)
+                         : find_best_turns_rec<false, false>(st, move(mtx), depth, alpha, beta);
+    }
+
+    /**
+     * Рекурсивный поиск с альфа-бета отсечением. Очередь хода Color и тип узла Is_max (ход бота,
+     * depth % 2 == 1) - параметры шаблона: генерация ходов, выбор минимума или максимума и цвет
+     * оценки в каждой специализации известны при компиляции
+     */
+    template <bool Color, bool Is_max>
+    double find_best_turns_rec(SearchState& st, vector<vector<POS_T>> mtx, const size_t depth,
+        double alpha = -1, double beta = INF + 1, const POS_T x = -1, const POS_T y = -1) const
     {
-        // База рекурсии - достигнута максимальная глубина
-        if (depth == Max_depth)
+        if (check_abort(st))
+            return 0;
+        // Ничья повторением или по правилу отсутствия прогресса (проверяется в начале хода)
+        if (x == -1 && is_draw(st, mtx, Color))
         {
-            return calc_score(mtx, (depth % 2 == color));
+            ++st.history_draws;
+            return DRAW;
         }
-        // Поиск возможных ходов для текущей позиции
+        // База рекурсии - достигнута максимальная глубина (с учетом сокращений и продлений O2)
+        const long long left = (static_cast<long long>(st.Max_depth) - static_cast<long long>(depth)) * Ply - st.reduction;
+        if (left <= 0)
+        {
+            return calc_score(mtx, Is_max == Color);
+        }
+        const size_t remaining = size_t((left + Ply - 1) / Ply); // Оставшаяся глубина в целых ходах
+        // Кэш поиска: оценка не мельче нужной заменяет поиск, если она точная или выходит за окно
+        const TranspositionTable::Entry* cached = nullptr;
+        uint64_t key = 0;
+        if (st.tt || st.cache)
+        {
+            key = node_key(mtx, Color, Is_max, x, y);
+            cached = probe_cache(st, key);
+            if (cached && cached->remaining >= remaining &&
+                (cached->bound == TranspositionTable::Bound::Exact ||
+                    (cached->bound == TranspositionTable::Bound::Lower && cached->score >= beta) ||
+                    (cached->bound == TranspositionTable::Bound::Upper && cached->score <= alpha)))
+                return cached->score;
+        }
+        // Поиск возможных ходов для текущей позиции (в буфер этого уровня на стеке)
+        Moves turns_now;
         if (x != -1)
         {
-            find_turns(x, y, mtx);
+            find_turns(x, y, mtx, turns_now);
         }
         else
-            find_turns(color, mtx);
-        auto turns_now = turns;
-        bool have_beats_now = have_beats;
+            find_turns<Color>(st, mtx, turns_now);
 
         // Если нет взятий и это продолжение хода конкретной фигуры
-        if (!have_beats_now && x != -1)
+        if (!turns_now.have_beats && x != -1)
         {
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
+            end_capture(mtx, x, y);
+            return find_best_turns_rec<!Color, !Is_max>(st, mtx, depth + 1, alpha, beta);
         }
 
         // Если нет возможных ходов
-        if (turns.empty())
-            return (depth % 2 ? 0 : INF);
+        if (turns_now.empty())
+            return (Is_max ? 0 : INF);
 
+        // Выборочный поиск O2 (только в начале тихого хода: взятия не сокращаются)
+        size_t node_reduction = 0; // Сокращение глубины всех ходов узла (razoring)
+        size_t lmr_from = Moves::Capacity; // С какого по счету хода применяется LMR
+        if (optimization == Optimization::O2 && x == -1 && !turns_now.have_beats)
+        {
+            const double eval = calc_score(mtx, Is_max == Color);
+            if (eval > 0 && eval < INF)
+            {
+                // Futility: перед листьями тихий ход почти не меняет оценку, безнадежный узел не раскрывается
+                if (use_futility && remaining == 1 &&
+                    (Is_max ? eval * Futility_margin <= alpha : eval >= beta * Futility_margin))
+                {
+                    ++st.stats.futility_prunes;
+                    return eval;
+                }
+                // Razoring: за два уровня до листьев безнадежный узел считается на уровень мельче
+                if (use_razoring && remaining == 2 &&
+                    (Is_max ? eval * Razor_margin <= alpha : eval >= beta * Razor_margin))
+                {
+                    ++st.stats.razorings;
+                    node_reduction = 1;
+                }
+                // ProbCut: если мелкий поиск уверенно выходит за окно, глубокий почти наверняка тоже
+                if (use_probcut && remaining >= Probcut_min_depth && (Is_max ? beta < INF : alpha > 0))
+                {
+                    const double bound = (Is_max ? beta * Probcut_margin : alpha / Probcut_margin);
+                    st.reduction += int(Probcut_reduction) * Ply;
+                    const double shallow =
+                        (Is_max ? find_best_turns_rec<Color, Is_max>(st, mtx, depth, bound - Eps, bound)
+                                : find_best_turns_rec<Color, Is_max>(st, mtx, depth, bound, bound + Eps));
+                    st.reduction -= int(Probcut_reduction) * Ply;
+                    if (Is_max ? shallow >= bound : shallow <= bound)
+                    {
+                        ++st.stats.probcut_cuts;
+                        return shallow;
+                    }
+                }
+            }
+            // LMR: лучшие по статической оценке ходы считаются полностью, поздние - на уровень мельче
+            if (use_lmr_setting && remaining >= Lmr_min_depth && turns_now.size() > Lmr_full_turns)
+                lmr_from = max(Lmr_full_turns, order_turns<Color, Is_max>(mtx, turns_now));
+        }
+        // Лучший ход из кэша считается первым (и без сокращения LMR)
+        if (cached && cached->turn.x != -1)
+        {
+            const size_t found = move_to_front(turns_now, cached->turn);
+            if (found < turns_now.size() && found >= lmr_from)
+                ++lmr_from;
+        }
+        const bool is_selective = (optimization == Optimization::O2);
+        // Продление O2: единственный ход в позиции (обычно обязательное взятие) считается глубже
+        int node_extension = 0;
+        if (is_selective && x == -1 && turns_now.size() == 1)
+        {
+            node_extension = extend(st, single_reply_extension);
+            st.stats.single_reply_extensions += (node_extension != 0);
+        }
+        // Сокращение O2 тихих ходов, оценка которых после хода намного хуже окна
+        const bool use_quiet_reduction = (is_selective && quiet_reduction && x == -1 && !turns_now.have_beats &&
+                                          remaining >= Quiet_min_depth);
+
+        const double alpha_start = alpha, beta_start = beta;
+        const unsigned long long history_draws = st.history_draws;
         double min_score = INF + 1;
         double max_score = -1;
+        move_pos best_turn(-1, -1, -1, -1);
         // Перебор всех возможных ходов
-        for (auto turn : turns_now)
+        for (size_t k = 0; k < turns_now.size(); ++k)
         {
+            const move_pos turn = turns_now[k];
             double score = 0.0;
-            if (!have_beats_now && x == -1)
+            if (!turns_now.have_beats && x == -1)
             {
                 // Обычный ход
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
+                const bool is_late = (k >= lmr_from);
+                bool is_hopeless = false;
+                if (use_quiet_reduction && k > 0)
+                {
+                    const double eval = calc_score(make_turn(mtx, turn), Is_max == Color);
+                    is_hopeless = (eval > 0 && eval < INF &&
+                                   (Is_max ? eval * Quiet_margin <= alpha : eval >= beta * Quiet_margin));
+                }
+                const int reduction =
+                    int(node_reduction + is_late) * Ply + (is_hopeless ? quiet_reduction : 0) - node_extension;
+                st.reduction += reduction;
+                score = search_after(st, mtx, Color, turn, [&](vector<vector<POS_T>> next) {
+                    return find_best_turns_rec<!Color, !Is_max>(st, move(next), depth + 1, alpha, beta);
+                });
+                st.reduction -= reduction;
+                st.stats.lmr_reductions += is_late;
+                st.stats.quiet_reductions += is_hopeless;
+                // Сокращенный ход оказался лучше ожидаемого - пересчет на полную глубину
+                if ((is_late || is_hopeless) && (Is_max ? score > alpha : score < beta))
+                {
+                    st.stats.lmr_researches += is_late;
+                    const int full = int(node_reduction) * Ply - node_extension;
+                    st.reduction += full;
+                    score = search_after(st, mtx, Color, turn, [&](vector<vector<POS_T>> next) {
+                        return find_best_turns_rec<!Color, !Is_max>(st, move(next), depth + 1, alpha, beta);
+                    });
+                    st.reduction -= full;
+                }
             }
             else
             {
-                // Продолжение серии ходов (для взятий)
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
+                // Продолжение серии ходов (для взятий), в O2 каждое взятие продлевает ветку
+                const int capture = (is_selective ? extend(st, capture_extension) : 0);
+                st.stats.capture_extensions += (capture != 0);
+                const int reduction = -node_extension - capture;
+                st.reduction += reduction;
+                score = search_after(st, mtx, Color, turn, [&](vector<vector<POS_T>> next) {
+                    return find_best_turns_rec<Color, Is_max>(st, move(next), depth, alpha, beta, turn.x2, turn.y2);
+                });
+                st.reduction -= reduction;
+                st.extension -= capture;
             }
             // Обновление минимальной и максимальной оценки
+            if (Is_max ? score > max_score : score < min_score)
+                best_turn = turn;
             min_score = min(min_score, score);
             max_score = max(max_score, score);
-            // Альфа-бета отсечение
-            if (depth % 2)
+            // Альфа-бета отсечение (оценка за окном - граница, она и возвращается)
+            if (Is_max)
                 alpha = max(alpha, max_score);
             else
                 beta = min(beta, min_score);
-            if (optimization != "O0" && alpha >= beta)
-                return (depth % 2 ? max_score + 1 : min_score - 1);
+            if (optimization != Optimization::O0 && alpha >= beta)
+                break;
+        }
+        st.extension -= node_extension;
+        const double score = (Is_max ? max_score : min_score);
+        if (st.tt && !st.aborted)
+        {
+            const auto bound = (score <= alpha_start   ? TranspositionTable::Bound::Upper
+                                : score >= beta_start ? TranspositionTable::Bound::Lower
+                                                      : TranspositionTable::Bound::Exact);
+            // Оценка поддерева с ничьей по истории верна только для этого пути: сохраняется
+            // лишь лучший ход (глубина 0 не заменяет поиск и не попадает в постоянный кэш)
+            const bool by_history = (st.history_draws != history_draws);
+            st.tt->store(key, score, by_history ? 0 : remaining - node_reduction, bound, best_turn);
+        }
+        return score;
+    }
+
+    /**
+     * Упорядочивание тихих ходов для LMR: сначала острые ходы (после них у соперника есть взятие),
+     * затем остальные по статической оценке после хода (лучшие для ходящего - первыми).
+     * @return Число острых ходов в начале списка (они не сокращаются)
+     */
+    template <bool Color, bool Is_max>
+    size_t order_turns(const vector<vector<POS_T>>& mtx, Moves& turns) const
+    {
+        array<double, Moves::Capacity> keys;
+        Moves replies;
+        size_t sharp = 0;
+        for (size_t k = 0; k < turns.size(); ++k)
+        {
+            const auto next = make_turn(mtx, turns[k]);
+            const double score = calc_score(next, Is_max == Color);
+            keys[k] = (Is_max ? -score : score);
+            replies.clear();
+            add_color_turns<!Color>(next, replies);
+            if (replies.have_beats)
+            {
+                keys[k] = -INF - 1.0;
+                ++sharp;
+            }
         }
-        return (depth % 2 ? max_score : min_score);
+        // Сортировка вставками: ходов в узле немного
+        for (size_t k = 1; k < turns.size(); ++k)
+        {
+            const double key = keys[k];
+            const move_pos turn = turns[k];
+            size_t i = k;
+            for (; i > 0 && keys[i - 1] > key; --i)
+            {
+                keys[i] = keys[i - 1];
+                turns[i] = turns[i - 1];
+            }
+            keys[i] = key;
+            turns[i] = turn;
+        }
+        return sharp;
     }
 
 public:
-    // Поиск всех возможных ходов для цвета
-    void find_turns(const bool color)
+    /**
+     * Поиск всех возможных ходов для цвета (со взятиями, если они есть).
+     * @return Список ходов, have_beats - есть ли взятия
+     */
+    Moves find_turns(const bool color, const vector<vector<POS_T>>& mtx) const
     {
-        find_turns(color, board->get_board());
+        Moves res;
+        if (color)
+            add_color_turns<true>(mtx, res);
+        else
+            add_color_turns<false>(mtx, res);
+        return res;
     }
 
-    // Поиск всех возможных ходов для конкретной фигуры
-    void find_turns(const POS_T x, const POS_T y)
+    // Поиск всех возможных ходов для конкретной фигуры (продолжение серии взятий)
+    Moves find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx) const
     {
-        find_turns(x, y, board->get_board());
+        Moves res;
+        add_turns(x, y, mtx, res);
+        keep_longest(mtx, res);
+        return res;
     }
 
-private:
-    // Поиск всех возможных ходов для цвета на заданной доске
-    void find_turns(const bool color, const vector<vector<POS_T>>& mtx)
+    // Все полные ходы цвета: тихие ходы и серии взятий, доведенные до конца
+    vector<vector<move_pos>> find_full_turns(const bool color, const vector<vector<POS_T>>& mtx) const
     {
-        vector<move_pos> res_turns;
-        bool have_beats_before = false;
-        // Перебор всех клеток доски
-        for (POS_T i = 0; i < 8; ++i)
+        vector<vector<move_pos>> res;
+        const Moves turns = find_turns(color, mtx);
+        for (auto turn : turns)
         {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                if (mtx[i][j] && mtx[i][j] % 2 != color) // Если фигура нужного цвета
-                {
-                    find_turns(i, j, mtx);
-                    // Приоритет взятий
-                    if (have_beats && !have_beats_before)
-                    {
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before)
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
-                }
-            }
+            vector<move_pos> chain{turn};
+            if (turns.have_beats)
+                add_chains(make_turn(mtx, turn), chain, res);
+            else
+                res.push_back(chain);
         }
-        turns = res_turns;
+        return res;
+    }
+
+private:
+    // Поиск всех возможных ходов цвета Color в буфер res (без выделения памяти)
+    template <bool Color>
+    void find_turns(SearchState& st, const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        res.clear();
+        add_color_turns<Color>(mtx, res);
         // Перемешивание ходов для разнообразия (если включено)
-        shuffle(turns.begin(), turns.end(), rand_eng);
-        have_beats = have_beats_before;
+        shuffle(res.begin(), res.end(), st.rand_eng);
     }
 
-    // Поиск всех возможных ходов для конкретной фигуры на заданной доске
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx)
+    void find_turns(SearchState& st, const bool color, const vector<vector<POS_T>>& mtx, Moves& res) const
     {
-        turns.clear();
-        have_beats = false;
-        POS_T type = mtx[x][y];
-        // Проверка возможных взятий
-        switch (type)
+        if (color)
+            find_turns<true>(st, mtx, res);
+        else
+            find_turns<false>(st, mtx, res);
+    }
+
+    // Поиск всех возможных ходов для конкретной фигуры в буфер res
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        res.clear();
+        add_turns(x, y, mtx, res);
+        keep_longest(mtx, res);
+    }
+
+    // Добавление ходов всех фигур цвета Color в res
+    template <bool Color>
+    void add_color_turns(const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        constexpr POS_T Man = (Color ? 2 : 1), King = Man + 2;
+        // Перебор игровых клеток доски
+        for (const auto cell : Variant::tables.cell)
+        {
+            const POS_T piece = mtx[cell.x][cell.y];
+            if (piece == Man)
+                add_turns<Man>(cell.x, cell.y, mtx, res);
+            else if (piece == King)
+                add_turns<King>(cell.x, cell.y, mtx, res);
+        }
+        keep_longest(mtx, res);
+    }
+
+    // Добавление ходов фигуры (x, y) в res (выбор специализации по типу фигуры)
+    void add_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        switch (mtx[x][y])
         {
         case 1: // Белая простая
+            add_turns<1>(x, y, mtx, res);
+            break;
         case 2: // Черная простая
-            // Проверка взятий для простых шашек
-            for (POS_T i = x - 2; i <= x + 2; i += 4)
+            add_turns<2>(x, y, mtx, res);
+            break;
+        case 3: // Белая дамка
+            add_turns<3>(x, y, mtx, res);
+            break;
+        case 4: // Черная дамка
+            add_turns<4>(x, y, mtx, res);
+            break;
+        }
+    }
+
+    // Добавление ходов фигуры Type с клетки (x, y) в res с учетом приоритета взятий:
+    // первое найденное взятие вытесняет ранее добавленные обычные ходы.
+    // Цвет, вид фигуры и направление хода простой известны при компиляции, клетки берутся
+    // из лучей таблицы геометрии (без проверок границ доски)
+    template <POS_T Type>
+    void add_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        constexpr bool Is_king = (Type > 2);
+        constexpr int Forward = (Type % 2 ? 0 : 2); // Первое направление хода простой (белые - вверх)
+        const auto& tables = Variant::tables;
+        const int sq = Variant::square(x, y);
+        const size_t before = res.size();
+        // Проверка возможных взятий
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const auto& ray = tables.ray[sq][dir];
+            if constexpr (!Is_king)
             {
-                for (POS_T j = y - 2; j <= y + 2; j += 4)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7)
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2;
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb);
-                }
+                // Взятие простой: соседняя клетка - фигура соперника, следующая - пустая
+                if (tables.ray_size[sq][dir] < 2)
+                    continue;
+                const auto over = ray[0], to = ray[1];
+                if (mtx[to.x][to.y] || !mtx[over.x][over.y] || mtx[over.x][over.y] % 2 == Type % 2 ||
+                    is_captured(mtx[over.x][over.y]))
+                    continue;
+                res.emplace_back(x, y, to.x, to.y, over.x, over.y);
             }
-            break;
-        default: // Дамки
-            // Проверка взятий для дамок
-            for (POS_T i = -1; i <= 1; i += 2)
+            else
             {
-                for (POS_T j = -1; j <= 1; j += 2)
+                // Взятие дамки: одна фигура соперника на луче, за ней - любые пустые клетки
+                POS_T xb = -1, yb = -1;
+                for (POS_T k = 0; k < tables.ray_size[sq][dir]; ++k)
                 {
-                    POS_T xb = -1, yb = -1;
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
+                    const auto cell = ray[k];
+                    if (mtx[cell.x][cell.y])
                     {
-                        if (mtx[i2][j2])
-                        {
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
-                            {
-                                break;
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2)
-                        {
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
-                        }
+                        if (mtx[cell.x][cell.y] % 2 == Type % 2 || xb != -1 || is_captured(mtx[cell.x][cell.y]))
+                            break;
+                        xb = cell.x;
+                        yb = cell.y;
                     }
+                    else if (xb != -1)
+                        res.emplace_back(x, y, cell.x, cell.y, xb, yb);
                 }
             }
-            break;
         }
-        // Если есть взятия - возвращаем только их
-        if (!turns.empty())
+        // Если есть взятия - в списке остаются только взятия
+        if (res.size() != before)
         {
-            have_beats = true;
+            if (!res.have_beats)
+                res.erase_front(before);
+            res.have_beats = true;
             return;
         }
+        if (res.have_beats)
+            return;
         // Проверка обычных ходов (если нет взятий)
-        switch (type)
+        if constexpr (!Is_king)
         {
-        case 1: // Белая простая
-        case 2: // Черная простая
-            // Обычные ходы для простых шашек
-        {
-            POS_T i = ((type % 2) ? x - 1 : x + 1); // Направление движения
-            for (POS_T j = y - 1; j <= y + 1; j += 2)
+            // Обычные ходы для простых шашек (на соседнюю клетку вперед)
+            for (int dir = Forward; dir < Forward + 2; ++dir)
             {
-                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
+                if (!tables.ray_size[sq][dir])
                     continue;
-                turns.emplace_back(x, y, i, j);
+                const auto to = tables.ray[sq][dir][0];
+                if (!mtx[to.x][to.y])
+                    res.emplace_back(x, y, to.x, to.y);
             }
-            break;
         }
-        default: // Дамки
-            // Обычные ходы для дамок
-            for (POS_T i = -1; i <= 1; i += 2)
+        else
+        {
+            // Обычные ходы для дамок (по лучу до первой фигуры)
+            for (int dir = 0; dir < 4; ++dir)
             {
-                for (POS_T j = -1; j <= 1; j += 2)
+                for (POS_T k = 0; k < tables.ray_size[sq][dir]; ++k)
                 {
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                            break;
-                        turns.emplace_back(x, y, i2, j2);
-                    }
+                    const auto cell = tables.ray[sq][dir][k];
+                    if (mtx[cell.x][cell.y])
+                        break;
+                    res.emplace_back(x, y, cell.x, cell.y);
                 }
             }
-            break;
         }
     }
 
-public:
-    vector<move_pos> turns; // Доступные ходы
-    bool have_beats; // Наличие взятий
-    int Max_depth; // Глубина анализа
+    // Правило большинства (международные шашки): из взятий остаются только те, с которых
+    // серия бьет наибольшее число фигур
+    void keep_longest(const vector<vector<POS_T>>& mtx, Moves& res) const
+    {
+        if constexpr (Variant::Majority_capture)
+        {
+            if (!res.have_beats || res.size() < 2)
+                return;
+            array<int, Moves::Capacity> lengths;
+            int longest = 0;
+            for (size_t k = 0; k < res.size(); ++k)
+            {
+                lengths[k] = capture_length(make_turn(mtx, res[k]), res[k].x2, res[k].y2);
+                longest = max(longest, lengths[k]);
+            }
+            size_t count = 0;
+            for (size_t k = 0; k < res.size(); ++k)
+            {
+                if (lengths[k] == longest)
+                    res[count++] = res[k];
+            }
+            res.truncate(count);
+        }
+    }
+
+    // Наибольшее число взятий, которое еще может сделать фигура (x, y)
+    int capture_length(const vector<vector<POS_T>>& mtx, const POS_T x, const POS_T y) const
+    {
+        Moves turns;
+        add_turns(x, y, mtx, turns);
+        if (!turns.have_beats)
+            return 0;
+        int res = 0;
+        for (auto turn : turns)
+            res = max(res, capture_length(make_turn(mtx, turn), turn.x2, turn.y2));
+        return res + 1;
+    }
+
+    // Конец серии взятий на клетке (x, y): по международным правилам простая становится дамкой
+    // только здесь, во время серии она бьет как простая, и только здесь снимаются побитые фигуры
+    void end_capture(vector<vector<POS_T>>& mtx, const POS_T x, const POS_T y) const
+    {
+        if constexpr (!Variant::Promote_in_capture)
+        {
+            if ((mtx[x][y] == 1 && x == 0) || (mtx[x][y] == 2 && x == Variant::Size - 1))
+                mtx[x][y] += 2;
+        }
+        if constexpr (Variant::Turkish_strike)
+        {
+            for (const auto cell : Variant::tables.cell)
+            {
+                if (mtx[cell.x][cell.y] == Captured_piece)
+                    mtx[cell.x][cell.y] = 0;
+            }
+        }
+    }
+
+    // Побитая в этой серии фигура (турецкий удар): преграда, которую нельзя бить второй раз
+    static constexpr bool is_captured(const POS_T piece)
+    {
+        return Variant::Turkish_strike && piece == Captured_piece;
+    }
 
 private:
-    default_random_engine rand_eng; // ГСЧ
-    string scoring_mode; // Стратегия оценки
-    string optimization; // Уровень оптимизации
-    vector<move_pos> next_move; // Последовательность ходов
-    vector<int> next_best_state; // Состояния ИИ
-    Board* board; // Игровое поле
-    Config* config; // Настройки
-};
\ No newline at end of file
+    bool no_random; // Детерминированный бот
+    size_t no_progress_limit; // Число обратимых ходов подряд до ничьей
+    bool use_lmr_setting, use_futility, use_razoring, use_probcut; // Приемы выборочного поиска O2
+    int single_reply_extension, capture_extension, quiet_reduction; // Продления и сокращения O2 (в долях Ply)
+    size_t arena_bytes; // Арена временной памяти поиска (0 - обычная куча)
+
+    // Параметры выборочного поиска O2 (оценка - отношение сил, поэтому запасы относительные)
+    static constexpr double Futility_margin = 1.15;  // Запас futility pruning (за уровень до листьев)
+    static constexpr double Razor_margin = 1.4;      // Запас razoring (за два уровня до листьев)
+    static constexpr double Probcut_margin = 1.1;    // Запас границы ProbCut
+    static constexpr size_t Probcut_min_depth = 4;   // Минимальная оставшаяся глубина для ProbCut
+    static constexpr size_t Probcut_reduction = 2;   // Насколько мельче проверочный поиск ProbCut
+    static constexpr size_t Lmr_min_depth = 3;       // Минимальная оставшаяся глубина для LMR
+    static constexpr size_t Lmr_full_turns = 3;      // Сколько лучших ходов считаются без сокращения
+    static constexpr double Eps = 1e-9;              // Ширина нулевого окна
+    static constexpr int Ply = Settings::Selective::Ply_units; // Долей в одном ходе (дробная глубина)
+    static constexpr double Quiet_margin = 1.3;      // Запас сокращения тихих ходов с оценкой хуже окна
+    static constexpr size_t Quiet_min_depth = 2;     // Минимальная оставшаяся глубина для него
+    static constexpr uint64_t Cache_format = 1;      // Версия записей кэша (1 - без оценок по истории партии)
+    ScoringType scoring_mode; // Стратегия оценки
+    Optimization optimization; // Уровень оптимизации
+};
+
+// Логика русских шашек (доска 8 x 8) - используется игрой и движком
+using Logic = BasicLogic<RussianDraughts>;
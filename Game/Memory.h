@@ -0,0 +1,283 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Подсистемы, по которым считаются выделения памяти
+enum class MemSubsystem : uint8_t
+{
+    Other,   // Все, что не отмечено
+    Search,  // Поиск бота (Logic::find_best_turns)
+    Solver,  // Решатель
+    History, // Журнал ходов доски и позиции партии
+    Log,     // Лог и трассировка
+    Count
+};
+
+// Счетчики выделений (разность двух снимков - выделения за интервал)
+struct MemUsage
+{
+    unsigned long long allocs = 0, frees = 0, bytes = 0;
+
+    MemUsage operator-(const MemUsage& other) const
+    {
+        return MemUsage{allocs - other.allocs, frees - other.frees, bytes - other.bytes};
+    }
+
+    MemUsage& operator+=(const MemUsage& other)
+    {
+        allocs += other.allocs;
+        frees += other.frees;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+/**
+ * Учет выделений памяти. Глобальные operator new/delete (MemoryHooks.h) вызывают allocate/release:
+ * перед каждым блоком хранится заголовок с размером и подсистемой, поэтому освобождение
+ * учитывается в той подсистеме, где блок выделен. Подсистема задается в потоке через MemScope.
+ * Для сравнения поиск может брать временную память из арены потока (SearchArena):
+ * выделение - сдвиг указателя, освобождение - ничего, арена очищается только в начале поиска.
+ */
+class Memory
+{
+public:
+    static constexpr size_t Subsystems = size_t(MemSubsystem::Count);
+
+    static const char* name(const MemSubsystem subsystem)
+    {
+        static const char* names[] = {"other", "search", "solver", "history", "log"};
+        return names[size_t(subsystem)];
+    }
+
+    static MemUsage usage(const MemSubsystem subsystem)
+    {
+        const Counters& c = counters[size_t(subsystem)];
+        return MemUsage{c.allocs.load(memory_order_relaxed), c.frees.load(memory_order_relaxed),
+                        c.bytes.load(memory_order_relaxed)};
+    }
+
+    // Выделения поиска, не поместившиеся в арену (взяты из обычной кучи)
+    static unsigned long long arena_overflows()
+    {
+        return overflows.load(memory_order_relaxed);
+    }
+
+    // Текущий размер резидентной памяти процесса (0 - неизвестен на этой платформе)
+    static long long resident_bytes()
+    {
+#ifdef __linux__
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (!f)
+            return 0;
+        long long pages = 0, resident = 0;
+        const int read = fscanf(f, "%lld %lld", &pages, &resident);
+        fclose(f);
+        return read == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    // Наибольший размер резидентной памяти за время работы процесса (0 - неизвестен)
+    static long long peak_resident_bytes()
+    {
+#ifndef _WIN32
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return usage.ru_maxrss; // В байтах
+#else
+        return usage.ru_maxrss * 1024ll; // В килобайтах
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * Выделение size байт с выравниванием align (не меньше выравнивания заголовка).
+     * @return nullptr, если памяти нет
+     */
+    static void* allocate(const size_t size, size_t align)
+    {
+        align = max(align, Header_size);
+        const size_t total = size + Header_size + (align > Header_size ? align : 0);
+        const MemSubsystem subsystem = current;
+        char* base = nullptr;
+        uint16_t flags = 0;
+        if (arena.active && subsystem == MemSubsystem::Search)
+        {
+            base = arena.take(total);
+            if (base)
+                flags = From_arena;
+            else
+                overflows.fetch_add(1, memory_order_relaxed);
+        }
+        if (!base)
+            base = static_cast<char*>(malloc(total));
+        if (!base)
+            return nullptr;
+        char* res = align_up(base + Header_size, align);
+        Header* header = reinterpret_cast<Header*>(res) - 1;
+        header->size = size;
+        header->offset = uint32_t(res - base);
+        header->subsystem = uint8_t(subsystem);
+        header->flags = flags;
+
+        Counters& c = counters[size_t(subsystem)];
+        c.allocs.fetch_add(1, memory_order_relaxed);
+        c.bytes.fetch_add(size, memory_order_relaxed);
+        return res;
+    }
+
+    static void release(void* ptr)
+    {
+        if (!ptr)
+            return;
+        const Header* header = static_cast<const Header*>(ptr) - 1;
+        counters[header->subsystem].frees.fetch_add(1, memory_order_relaxed);
+        if (header->flags & From_arena)
+            return; // Память арены освобождается вся сразу
+        free(static_cast<char*>(ptr) - header->offset);
+    }
+
+private:
+    friend class MemScope;
+    friend class SearchArena;
+
+    struct Counters
+    {
+        atomic<unsigned long long> allocs, frees, bytes;
+    };
+
+    // Заголовок блока (занимает выравнивание malloc, поэтому блок остается выровненным)
+    struct alignas(16) Header
+    {
+        uint64_t size;
+        uint32_t offset; // От начала выделенной памяти до блока
+        uint8_t subsystem;
+        uint8_t reserved;
+        uint16_t flags;
+    };
+
+    // Арена потока: один буфер, выделение - сдвиг указателя (поля обнулены как у любой thread_local)
+    struct Arena
+    {
+        char* base;
+        size_t size, used;
+        bool active;
+
+        char* take(const size_t bytes)
+        {
+            const size_t start = (used + Header_size - 1) / Header_size * Header_size;
+            if (start + bytes > size)
+                return nullptr;
+            used = start + bytes;
+            return base + start;
+        }
+
+        ~Arena()
+        {
+            active = false;
+            free(base);
+            base = nullptr;
+        }
+    };
+
+    static constexpr size_t Header_size = sizeof(Header);
+    static constexpr uint16_t From_arena = 1;
+
+    static char* align_up(char* ptr, const size_t align)
+    {
+        const uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+        return ptr + (align - value % align) % align;
+    }
+
+    // Статическая инициализация нулями: счетчики работают и до запуска main
+    static inline Counters counters[Subsystems];
+    static inline atomic<unsigned long long> overflows;
+    static inline thread_local MemSubsystem current = MemSubsystem::Other;
+    static inline thread_local Arena arena;
+};
+
+/**
+ * Подсистема выделений памяти потока на время жизни объекта (как TraceScope для трассировки).
+ */
+class MemScope
+{
+public:
+    explicit MemScope(const MemSubsystem subsystem) : previous(Memory::current)
+    {
+        Memory::current = subsystem;
+    }
+
+    ~MemScope()
+    {
+        Memory::current = previous;
+    }
+
+    MemScope(const MemScope&) = delete;
+    MemScope& operator=(const MemScope&) = delete;
+
+private:
+    const MemSubsystem previous;
+};
+
+/**
+ * Включение арены потока для выделений подсистемы Search на время жизни объекта.
+ * Буфер арены создается при первом использовании в потоке (и при смене размера) и очищается
+ * только в начале внешней области, то есть в начале поиска. Поэтому в области выделяется лишь
+ * временная память поиска: долгоживущее (файл кэша, события трассировки) выделяется под MemScope
+ * своей подсистемы и в арену не попадает, а результат поиска копируется в кучу после release.
+ */
+class SearchArena
+{
+public:
+    explicit SearchArena(const size_t bytes)
+    {
+        auto& arena = Memory::arena;
+        if (arena.active)
+            return; // Вложенная область пользуется ареной внешней
+        if (arena.size != bytes)
+        {
+            free(arena.base);
+            arena.base = static_cast<char*>(malloc(bytes));
+            arena.size = (arena.base ? bytes : 0);
+        }
+        arena.used = 0;
+        arena.active = (arena.base != nullptr);
+        is_owner = arena.active;
+    }
+
+    // Дальнейшие выделения - снова из обычной кучи (выделенное в арене остается доступным)
+    void release()
+    {
+        if (is_owner)
+            Memory::arena.active = false;
+        is_owner = false;
+    }
+
+    ~SearchArena()
+    {
+        release();
+    }
+
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+
+private:
+    bool is_owner = false;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <new>
+
+#include "Memory.h"
+
+// Замена глобальных operator new/delete для учета памяти (Memory). Определения не inline
+// (так требует стандарт), поэтому файл подключается ровно в одном файле программы -
+// в main.cpp и engine.cpp.
+
+namespace memory_hooks
+{
+inline void* allocate(const size_t size, const size_t align)
+{
+    void* res = Memory::allocate(size, align);
+    if (!res)
+        throw bad_alloc();
+    return res;
+}
+} // namespace memory_hooks
+
+void* operator new(size_t size)
+{
+    return memory_hooks::allocate(size, alignof(max_align_t));
+}
+
+void* operator new[](size_t size)
+{
+    return memory_hooks::allocate(size, alignof(max_align_t));
+}
+
+void* operator new(size_t size, align_val_t align)
+{
+    return memory_hooks::allocate(size, size_t(align));
+}
+
+void* operator new[](size_t size, align_val_t align)
+{
+    return memory_hooks::allocate(size, size_t(align));
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return Memory::allocate(size, alignof(max_align_t));
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return Memory::allocate(size, alignof(max_align_t));
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept
+{
+    return Memory::allocate(size, size_t(align));
+}
+
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept
+{
+    return Memory::allocate(size, size_t(align));
+}
+
+void operator delete(void* ptr) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete(void* ptr, align_val_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete(void* ptr, size_t, align_val_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t, align_val_t) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete(void* ptr, align_val_t, const nothrow_t&) noexcept
+{
+    Memory::release(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t, const nothrow_t&) noexcept
+{
+    Memory::release(ptr);
+}
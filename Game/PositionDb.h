@@ -0,0 +1,490 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../Models/Geometry.h"
+#include "../Models/Move.h"
+#include "../Models/Notation.h"
+#include "../Models/Zobrist.h"
+
+using namespace std;
+
+/**
+ * База позиций партий: для каждой позиции, встреченной в партиях, - число партий, результаты
+ * (с точки зрения ходящего) и сыгранные в ней ходы с их результатами.
+ * Позиция с ходом черных хранится как зеркальная (доска повернута, цвета фигур обменены)
+ * позиция с ходом белых, поэтому ключ - хеш позиции с ходом белых.
+ * Файл: заголовок, позиции по возрастанию ключа, затем ходы позиций подряд. Файл отображается
+ * в память только для чтения, поиск позиции - двоичный поиск по ключу.
+ */
+class PositionDb
+{
+public:
+    // Итог партий после хода или в позиции
+    struct Counts
+    {
+        uint32_t games = 0, wins = 0, draws = 0, losses = 0; // Результаты с точки зрения ходящего
+    };
+
+    struct MoveStats
+    {
+        vector<move_pos> turns; // Ход в позиции запроса
+        Counts counts;
+    };
+
+    struct Stats
+    {
+        Counts counts;
+        vector<MoveStats> moves; // По убыванию числа партий
+    };
+
+    explicit PositionDb(const string& path)
+    {
+        open(path);
+    }
+
+    PositionDb(const PositionDb&) = delete;
+    PositionDb& operator=(const PositionDb&) = delete;
+
+    ~PositionDb()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(mapped, mapped_size);
+#endif
+    }
+
+    // Файл открыт и подходит
+    bool is_open() const
+    {
+        return positions != nullptr;
+    }
+
+    size_t size() const
+    {
+        return position_count;
+    }
+
+    /**
+     * Статистика позиции mtx с ходом color.
+     * @return false, если позиции нет в базе
+     */
+    bool probe(const vector<vector<POS_T>>& mtx, const bool color, Stats& res) const
+    {
+        res = Stats{};
+        if (!is_open() || mtx.size() != RussianDraughts::Size)
+            return false;
+        const uint64_t key = position_key(mtx, color);
+        const Position* found = lower_bound(positions, positions + position_count, key,
+                                            [](const Position& pos, const uint64_t k) { return pos.key < k; });
+        if (found == positions + position_count || found->key != key)
+            return false;
+        res.counts = found->counts;
+        const uint64_t end = (found + 1 < positions + position_count ? found[1].first_move : move_count);
+        for (uint64_t k = found->first_move; k < end; ++k)
+        {
+            auto turns = decode_move(moves[k].code, mtx, color);
+            if (!turns.empty())
+                res.moves.push_back(MoveStats{move(turns), moves[k].counts});
+        }
+        stable_sort(res.moves.begin(), res.moves.end(),
+                    [](const MoveStats& a, const MoveStats& b) { return a.counts.games > b.counts.games; });
+        return true;
+    }
+
+    // Ключ позиции: хеш позиции, приведенной к ходу белых
+    static uint64_t position_key(const vector<vector<POS_T>>& mtx, const bool color)
+    {
+        return Zobrist::hash(color ? flip(mtx) : mtx, false);
+    }
+
+    /**
+     * Код хода в позиции, приведенной к ходу белых: в младших 4 битах - число полей после
+     * начального (1-11), дальше по 5 бит номера игровых клеток (начальная, затем поля серии).
+     * @return 0, если серия длиннее 11 ходов (такой ход не хранится)
+     */
+    static uint64_t encode_move(const vector<move_pos>& turns, const bool color)
+    {
+        if (turns.empty() || turns.size() > Max_steps)
+            return 0;
+        auto square = [color](const POS_T x, const POS_T y) {
+            const int sq = RussianDraughts::square(x, y);
+            return uint64_t(color ? RussianDraughts::Squares - 1 - sq : sq);
+        };
+        uint64_t res = turns.size() | square(turns[0].x, turns[0].y) << 4;
+        for (size_t k = 0; k < turns.size(); ++k)
+            res |= square(turns[k].x2, turns[k].y2) << (4 + 5 * (k + 1));
+        return res;
+    }
+
+    // Доска с ходом черных как доска с ходом белых: поворот на 180 градусов и обмен цветов
+    static vector<vector<POS_T>> flip(const vector<vector<POS_T>>& mtx)
+    {
+        const POS_T size = POS_T(mtx.size());
+        vector<vector<POS_T>> res(size, vector<POS_T>(size, 0));
+        for (POS_T i = 0; i < size; ++i)
+        {
+            for (POS_T j = 0; j < size; ++j)
+            {
+                const POS_T piece = mtx[i][j];
+                res[size - 1 - i][size - 1 - j] = (piece ? (piece % 2 ? piece + 1 : piece - 1) : 0);
+            }
+        }
+        return res;
+    }
+
+private:
+    friend class PositionDbBuilder;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t positions, moves, games;
+    };
+
+    struct Position
+    {
+        uint64_t key;
+        Counts counts;
+        uint64_t first_move; // Номер первого хода позиции (ходы следующей позиции идут сразу за ними)
+    };
+
+    struct Move
+    {
+        uint64_t code; // encode_move
+        Counts counts;
+    };
+
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t Max_steps = 11;
+
+    static Header make_header()
+    {
+        Header header{};
+        memcpy(header.magic, "CHKPOSDB", 8);
+        header.version = Version;
+        return header;
+    }
+
+    // Ход по коду (в координатах позиции запроса), пустой - код не подходит к позиции
+    static vector<move_pos> decode_move(const uint64_t code, const vector<vector<POS_T>>& mtx, const bool color)
+    {
+        const size_t steps = code & 15;
+        if (!steps || steps > Max_steps)
+            return {};
+        auto cell = [&](const size_t k) {
+            int sq = int((code >> (4 + 5 * k)) & 31);
+            if (color)
+                sq = RussianDraughts::Squares - 1 - sq;
+            const auto c = RussianDraughts::tables.cell[sq];
+            return cell_to_str(c.x, c.y);
+        };
+        // Взятые фигуры восстанавливаются по доске при разборе записи
+        string text = cell(0);
+        for (size_t k = 1; k <= steps; ++k)
+            text += "-" + cell(k);
+        return str_to_turns(text, mtx);
+    }
+
+    void open(const string& path)
+    {
+#ifndef _WIN32
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header))
+        {
+            void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                mapped = data;
+                mapped_size = size_t(st.st_size);
+                if (!attach((const char*)data, mapped_size))
+                {
+                    munmap(data, mapped_size);
+                    mapped = nullptr;
+                }
+            }
+        }
+        close(fd);
+#else
+        // Без mmap файл читается целиком
+        ifstream fin(path, ios::binary | ios::ate);
+        if (!fin)
+            return;
+        loaded.resize(size_t(fin.tellg()));
+        fin.seekg(0);
+        if (fin.read(loaded.data(), streamsize(loaded.size())))
+            attach(loaded.data(), loaded.size());
+#endif
+    }
+
+    /**
+     * Проверка заголовка, размеров разделов и ссылок позиций на ходы: ключи возрастают,
+     * first_move не убывает и не выходит за число ходов. Поврежденный или обрезанный файл
+     * не используется, поэтому probe не проверяет границы.
+     */
+    bool attach(const char* data, const size_t size)
+    {
+        if (size < sizeof(Header))
+            return false;
+        Header header;
+        memcpy(&header, data, sizeof(header));
+        const Header expected = make_header();
+        const size_t body = size - sizeof(Header);
+        if (memcmp(header.magic, expected.magic, 8) != 0 || header.version != Version ||
+            header.positions > body / sizeof(Position) || header.moves > body / sizeof(Move) ||
+            body != header.positions * sizeof(Position) + header.moves * sizeof(Move))
+            return false;
+        const Position* file_positions = (const Position*)(data + sizeof(Header));
+        for (uint64_t k = 0; k < header.positions; ++k)
+        {
+            const Position& pos = file_positions[k];
+            if (pos.first_move > header.moves ||
+                (k > 0 && (pos.key <= file_positions[k - 1].key || pos.first_move < file_positions[k - 1].first_move)))
+                return false;
+        }
+        position_count = size_t(header.positions);
+        move_count = size_t(header.moves);
+        positions = file_positions;
+        moves = (const Move*)(data + sizeof(Header) + position_count * sizeof(Position));
+        return true;
+    }
+
+private:
+    const Position* positions = nullptr;
+    const Move* moves = nullptr;
+    size_t position_count = 0, move_count = 0;
+    void* mapped = nullptr;
+    size_t mapped_size = 0;
+#ifdef _WIN32
+    vector<char> loaded;
+#endif
+};
+
+/**
+ * Построение базы позиций из потока позиций партий без ограничения по памяти: записи
+ * (позиция, ход, результат) копятся в буфере, отсортированный буфер сбрасывается во временный
+ * файл, в конце временные файлы сливаются в файл базы.
+ */
+class PositionDbBuilder
+{
+public:
+    // Результат партии
+    enum class Result
+    {
+        Unknown,
+        WhiteWin,
+        Draw,
+        BlackWin
+    };
+
+    /**
+     * @param path Файл базы (создается в finish)
+     * @param run_size Число записей в буфере до сброса во временный файл
+     */
+    explicit PositionDbBuilder(const string& path, const size_t run_size = size_t(1) << 22)
+        : path(path), run_size(run_size)
+    {
+        buffer.reserve(run_size);
+    }
+
+    ~PositionDbBuilder()
+    {
+        for (const auto& run : runs)
+            remove(run.c_str());
+    }
+
+    // Начало партии с результатом result (повторы позиции в одной партии считаются один раз)
+    void begin_game(const Result game_result)
+    {
+        result = game_result;
+        seen.clear();
+        ++games;
+    }
+
+    // Позиция партии и сделанный в ней ход (пустой - последняя позиция партии)
+    bool add(const vector<vector<POS_T>>& mtx, const bool color, const vector<move_pos>& turns)
+    {
+        const uint64_t key = PositionDb::position_key(mtx, color);
+        if (!seen.insert(key).second)
+            return false;
+        Record rec{key, PositionDb::encode_move(turns, color), {1, 0, 0, 0}};
+        // Результат с точки зрения ходящего
+        if (result == Result::Draw)
+            rec.counts.draws = 1;
+        else if (result != Result::Unknown)
+            ((result == Result::WhiteWin) != color ? rec.counts.wins : rec.counts.losses) = 1;
+        buffer.push_back(rec);
+        if (buffer.size() >= run_size && !flush_run())
+            is_failed = true;
+        return true;
+    }
+
+    /**
+     * Слияние временных файлов в файл базы (запись во временный файл и замена).
+     * @return false при ошибке записи (error - описание)
+     */
+    bool finish(string* error = nullptr)
+    {
+        if (is_failed || !flush_run())
+            return fail(error, "can't write " + path + ".run");
+        // Слияние отсортированных временных файлов
+        vector<ifstream> inputs;
+        for (const auto& run : runs)
+            inputs.emplace_back(run, ios::binary);
+        auto greater = [](const pair<Record, size_t>& a, const pair<Record, size_t>& b) { return less(b.first, a.first); };
+        priority_queue<pair<Record, size_t>, vector<pair<Record, size_t>>, decltype(greater)> heads(greater);
+        for (size_t k = 0; k < inputs.size(); ++k)
+        {
+            Record rec;
+            if (inputs[k].read((char*)&rec, sizeof(rec)))
+                heads.emplace(rec, k);
+        }
+
+        const string tmp_path = path + ".tmp", moves_path = path + ".moves";
+        ofstream fout(tmp_path, ios::binary | ios::trunc), moves_out(moves_path, ios::binary | ios::trunc);
+        PositionDb::Header header = PositionDb::make_header();
+        fout.write((const char*)&header, sizeof(header));
+        PositionDb::Position position{0, {}, 0};
+        PositionDb::Move move_stats{0, {}};
+        bool has_position = false, has_move = false;
+        auto write_move = [&] {
+            if (has_move && move_stats.code)
+            {
+                moves_out.write((const char*)&move_stats, sizeof(move_stats));
+                ++header.moves;
+            }
+            has_move = false;
+        };
+        auto write_position = [&] {
+            write_move();
+            if (has_position)
+            {
+                fout.write((const char*)&position, sizeof(position));
+                ++header.positions;
+            }
+            has_position = false;
+        };
+        while (!heads.empty())
+        {
+            const auto [rec, k] = heads.top();
+            heads.pop();
+            Record next;
+            if (inputs[k].read((char*)&next, sizeof(next)))
+                heads.emplace(next, k);
+            if (!has_position || rec.key != position.key)
+            {
+                write_position();
+                position = PositionDb::Position{rec.key, {}, header.moves};
+                has_position = true;
+            }
+            if (!has_move || rec.move != move_stats.code)
+            {
+                write_move();
+                move_stats = PositionDb::Move{rec.move, {}};
+                has_move = true;
+            }
+            add_counts(position.counts, rec.counts);
+            add_counts(move_stats.counts, rec.counts);
+        }
+        write_position();
+        moves_out.close();
+
+        // Ходы дописываются за позициями, заголовок - с итоговыми размерами
+        ifstream moves_in(moves_path, ios::binary);
+        if (header.moves)
+            fout << moves_in.rdbuf();
+        moves_in.close();
+        remove(moves_path.c_str());
+        header.games = games;
+        fout.seekp(0);
+        fout.write((const char*)&header, sizeof(header));
+        fout.close();
+        if (!fout)
+            return fail(error, "can't write " + tmp_path);
+#ifdef _WIN32
+        remove(path.c_str()); // rename на Windows не заменяет существующий файл
+#endif
+        if (rename(tmp_path.c_str(), path.c_str()) != 0)
+            return fail(error, "can't write " + path);
+        return true;
+    }
+
+private:
+    struct Record
+    {
+        uint64_t key;
+        uint64_t move;
+        PositionDb::Counts counts;
+    };
+
+    static bool less(const Record& a, const Record& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    }
+
+    static void add_counts(PositionDb::Counts& to, const PositionDb::Counts& from)
+    {
+        to.games += from.games;
+        to.wins += from.wins;
+        to.draws += from.draws;
+        to.losses += from.losses;
+    }
+
+    static bool fail(string* error, const string& text)
+    {
+        if (error)
+            *error = text;
+        return false;
+    }
+
+    // Сортировка буфера со слиянием одинаковых записей и запись во временный файл
+    bool flush_run()
+    {
+        if (buffer.empty())
+            return true;
+        sort(buffer.begin(), buffer.end(), less);
+        size_t count = 0;
+        for (size_t k = 0; k < buffer.size(); ++k)
+        {
+            if (count && buffer[count - 1].key == buffer[k].key && buffer[count - 1].move == buffer[k].move)
+                add_counts(buffer[count - 1].counts, buffer[k].counts);
+            else
+                buffer[count++] = buffer[k];
+        }
+        const string run = path + ".run" + to_string(runs.size());
+        runs.push_back(run);
+        ofstream fout(run, ios::binary | ios::trunc);
+        fout.write((const char*)buffer.data(), streamsize(count * sizeof(Record)));
+        buffer.clear();
+        return bool(fout);
+    }
+
+private:
+    const string path;
+    const size_t run_size;
+    vector<Record> buffer;
+    vector<string> runs;   // Временные файлы (удаляются в деструкторе)
+    unordered_set<uint64_t> seen; // Позиции текущей партии
+    Result result = Result::Unknown;
+    uint64_t games = 0;
+    bool is_failed = false;
+};
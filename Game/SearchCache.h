@@ -0,0 +1,248 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Memory.h"
+#include "TranspositionTable.h"
+
+using namespace std;
+
+/**
+ * Постоянный кэш поиска в файле: записи таблицы транспозиций (хеш узла, глубина, граница,
+ * оценка, лучший ход), накопленные прошлыми партиями. Файл отображается в память при первом
+ * обращении только для чтения, поэтому несколько процессов читают его совместно.
+ * merge() дописывает в файл глубокие записи таблицы текущего процесса: под блокировкой
+ * собирается новая копия файла и атомарно заменяет старую (уже отображенные копии
+ * других процессов остаются целыми). Кэш с другой подписью настроек оценки не используется.
+ */
+class SearchCache
+{
+public:
+    using Entry = TranspositionTable::Entry;
+
+    static constexpr size_t Min_remaining = 2; // Записи мельче не сохраняются (их дешевле пересчитать)
+
+    /**
+     * @param path Путь к файлу кэша
+     * @param signature Подпись настроек, от которых зависят оценки (Logic::cache_signature)
+     * @param size_mb Размер файла, создаваемого при первом merge
+     */
+    SearchCache(const string& path, const uint64_t signature, const size_t size_mb)
+        : path(path), signature(signature), size_mb(size_mb)
+    {
+    }
+
+    SearchCache(const SearchCache&) = delete;
+    SearchCache& operator=(const SearchCache&) = delete;
+
+    ~SearchCache()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(mapped, mapped_size);
+#endif
+    }
+
+    // Запись узла key или nullptr (файл открывается при первом вызове)
+    const Entry* probe(const uint64_t key) const
+    {
+        call_once(opened, [this] {
+            MemScope mem(MemSubsystem::Other); // Открывается во время поиска, но живет дольше него
+            open();
+        });
+        if (!count)
+            return nullptr;
+        const Entry& entry = entries[key & (count - 1)];
+        return (entry.bound != TranspositionTable::Bound::None && entry.key == key) ? &entry : nullptr;
+    }
+
+    /**
+     * Добавляет в файл записи tt не мельче Min_remaining (при совпадении места остается более глубокая).
+     * @return Число добавленных записей или -1 при ошибке записи (error - описание)
+     */
+    long long merge(const TranspositionTable& tt, string* error = nullptr) const
+    {
+#ifndef _WIN32
+        // Блокировка от одновременного merge нескольких процессов
+        const int lock_fd = ::open((path + ".lock").c_str(), O_CREAT | O_RDWR, 0644);
+        if (lock_fd < 0 || flock(lock_fd, LOCK_EX))
+        {
+            if (lock_fd >= 0)
+                close(lock_fd);
+            if (error)
+                *error = "can't lock " + path + ".lock";
+            return -1;
+        }
+#endif
+        // Текущее содержимое файла (его мог обновить другой процесс) в таблицу нужного размера
+        vector<Entry> table(entries_count(size_mb));
+        long long added = 0;
+        vector<Entry> current;
+        if (read_file(current))
+        {
+            for (const auto& entry : current)
+                insert(table, entry);
+        }
+        for (const auto& entry : tt.data())
+        {
+            if (entry.bound != TranspositionTable::Bound::None && entry.remaining >= Min_remaining)
+                added += insert(table, entry);
+        }
+
+        const string tmp_path = path + ".tmp";
+        bool is_written = false;
+        {
+            ofstream fout(tmp_path, ios::binary | ios::trunc);
+            Header header = make_header(table.size());
+            fout.write((const char*)&header, sizeof(header));
+            fout.write((const char*)table.data(), streamsize(table.size() * sizeof(Entry)));
+            is_written = bool(fout);
+        }
+        if (is_written)
+        {
+#ifdef _WIN32
+            remove(path.c_str()); // rename на Windows не заменяет существующий файл
+#endif
+            is_written = (rename(tmp_path.c_str(), path.c_str()) == 0);
+        }
+#ifndef _WIN32
+        flock(lock_fd, LOCK_UN);
+        close(lock_fd);
+#endif
+        if (!is_written)
+        {
+            if (error)
+                *error = "can't write " + path;
+            return -1;
+        }
+        return added;
+    }
+
+private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_size;
+        uint64_t signature;
+        uint64_t count; // Число записей (степень двойки)
+    };
+
+    static constexpr uint32_t Version = 1;
+
+    Header make_header(const size_t entries_count) const
+    {
+        Header header{};
+        memcpy(header.magic, "CHKCACHE", 8);
+        header.version = Version;
+        header.entry_size = uint32_t(sizeof(Entry));
+        header.signature = signature;
+        header.count = entries_count;
+        return header;
+    }
+
+    bool is_valid(const Header& header, const size_t file_size) const
+    {
+        const Header expected = make_header(header.count);
+        return memcmp(header.magic, expected.magic, 8) == 0 && header.version == Version &&
+               header.entry_size == expected.entry_size && header.signature == signature && header.count &&
+               (header.count & (header.count - 1)) == 0 && file_size == sizeof(Header) + header.count * sizeof(Entry);
+    }
+
+    static size_t entries_count(const size_t size_mb)
+    {
+        size_t count = 1024;
+        while (count * 2 * sizeof(Entry) <= size_mb * 1024 * 1024)
+            count *= 2;
+        return count;
+    }
+
+    // Вставка с заменой менее глубокой записи, 1 - запись добавлена
+    static int insert(vector<Entry>& table, const Entry& entry)
+    {
+        Entry& slot = table[entry.key & (table.size() - 1)];
+        if (slot.bound != TranspositionTable::Bound::None && slot.remaining > entry.remaining)
+            return 0;
+        slot = entry;
+        slot.generation = 0;
+        return 1;
+    }
+
+    // Отображение файла в память (при ошибке или несовпадении подписи кэш пуст)
+    void open() const
+    {
+#ifndef _WIN32
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header))
+        {
+            void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                const Header& header = *(const Header*)data;
+                if (is_valid(header, size_t(st.st_size)))
+                {
+                    mapped = data;
+                    mapped_size = size_t(st.st_size);
+                    entries = (const Entry*)((const char*)data + sizeof(Header));
+                    count = header.count;
+                }
+                else
+                    munmap(data, size_t(st.st_size));
+            }
+        }
+        close(fd);
+#else
+        // Без mmap файл читается целиком
+        if (read_file(loaded))
+        {
+            entries = loaded.data();
+            count = loaded.size();
+        }
+#endif
+    }
+
+    // Чтение записей файла, false - файла нет или он не подходит
+    bool read_file(vector<Entry>& res) const
+    {
+        ifstream fin(path, ios::binary | ios::ate);
+        if (!fin)
+            return false;
+        const size_t file_size = size_t(fin.tellg());
+        Header header{};
+        fin.seekg(0);
+        if (file_size < sizeof(Header) || !fin.read((char*)&header, sizeof(header)) || !is_valid(header, file_size))
+            return false;
+        res.resize(header.count);
+        return bool(fin.read((char*)res.data(), streamsize(res.size() * sizeof(Entry))));
+    }
+
+private:
+    const string path;
+    const uint64_t signature;
+    const size_t size_mb;
+
+    mutable once_flag opened;
+    mutable const Entry* entries = nullptr;
+    mutable size_t count = 0;
+    mutable void* mapped = nullptr;
+    mutable size_t mapped_size = 0;
+#ifdef _WIN32
+    mutable vector<Entry> loaded;
+#endif
+};
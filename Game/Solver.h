@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Zobrist.h"
+#include "Config.h"
+#include "Logic.h"
+
+using namespace std;
+
+/**
+ * Таблица доказательства (proof number, disproof number) узлов для решателя.
+ * Размер фиксирован, при совпадении места остается узел, на который потрачено больше работы.
+ */
+class ProofTable
+{
+public:
+    explicit ProofTable(const size_t size_mb = 16)
+    {
+        size_t count = 1024;
+        while (count * 2 * sizeof(Entry) <= size_mb * 1024 * 1024)
+            count *= 2;
+        entries.assign(count, Entry{});
+        mask = count - 1;
+    }
+
+    void clear()
+    {
+        entries.assign(entries.size(), Entry{});
+    }
+
+    // pn/dn узла key, false - узла нет в таблице
+    bool lookup(const uint64_t key, uint32_t& pn, uint32_t& dn) const
+    {
+        const Entry& entry = entries[key & mask];
+        if (entry.key != key || !entry.work)
+            return false;
+        pn = entry.pn;
+        dn = entry.dn;
+        return true;
+    }
+
+    void store(const uint64_t key, const uint32_t pn, const uint32_t dn, const uint32_t work)
+    {
+        Entry& entry = entries[key & mask];
+        if (entry.key != key && entry.work > work)
+            return;
+        entry = Entry{key, pn, dn, max(work, 1u)};
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t key = 0;
+        uint32_t pn = 0, dn = 0;
+        uint32_t work = 0; // Число узлов поддерева при последнем расчете (0 - пустая запись)
+    };
+
+    vector<Entry> entries;
+    size_t mask = 0;
+};
+
+// Итог решения позиции
+struct SolveResult
+{
+    enum class Outcome
+    {
+        Unknown, // Не доказано за отведенное число узлов
+        Win,     // Ходящий выигрывает при любой защите
+        Loss     // Ходящий проигрывает при любой игре
+    };
+
+    Outcome outcome = Outcome::Unknown;
+    vector<vector<move_pos>> line; // Доказанная линия (ходы сторон по очереди), при выигрыше line[0] - ход
+    unsigned long long nodes = 0;
+};
+
+/**
+ * Решатель df-pn (поиск по числам доказательства в глубину): доказывает форсированный выигрыш
+ * или проигрыш без ограничения глубины, в отличие от альфа-беты, которой выигрыш дальше
+ * горизонта не виден. Ход - полная серия взятий, проигрывает сторона без ходов.
+ * Ничья (повторение позиции на пути, правило отсутствия прогресса, предел длины линии)
+ * считается неудачей доказывающей стороны. Счетчик обратимых ходов входит в ключ узла,
+ * поэтому граф поиска без циклов. Таблица передается снаружи и может сохраняться
+ * между ходами: повторное решение уже доказанной позиции почти мгновенно.
+ */
+class Solver
+{
+public:
+    explicit Solver(const Config* config)
+        : logic(config), no_progress_limit(size_t(config->settings().game.no_progress_turns))
+    {
+    }
+
+    /**
+     * Решение позиции: сначала доказательство выигрыша ходящего, затем - выигрыша соперника.
+     * @param history Хеши позиций партии после последнего необратимого хода (как SearchParams::history)
+     * @param max_nodes Предел числа узлов на оба доказательства
+     * @param control Внешняя остановка (nullptr - нет)
+     */
+    SolveResult solve(const vector<vector<POS_T>>& mtx, const bool color, const vector<uint64_t>& history,
+                      ProofTable& table, const unsigned long long max_nodes, SearchControl* control = nullptr) const
+    {
+        TraceScope trace("solve", "search");
+        MemScope mem(MemSubsystem::Solver);
+        SolveResult res;
+        for (const bool attacker : {color, !color})
+        {
+            // На доказательство выигрыша - половина узлов, на проигрыш - остаток
+            const unsigned long long budget = (attacker == color ? max_nodes / 2 : max_nodes - res.nodes);
+            State st{table, attacker, history, history.size(), budget, control};
+            uint32_t pn, dn;
+            mid(st, mtx, color, Infinity, Infinity, pn, dn);
+            res.nodes += st.nodes;
+            if (pn == 0)
+            {
+                res.outcome = (attacker == color ? SolveResult::Outcome::Win : SolveResult::Outcome::Loss);
+                res.line = proven_line(st, mtx, color);
+                break;
+            }
+            if (st.aborted && st.nodes < budget)
+                break; // Внешняя остановка
+        }
+        trace.arg("nodes", (long long)res.nodes);
+        return res;
+    }
+
+private:
+    static constexpr uint32_t Infinity = 1u << 30;
+    static constexpr size_t Max_plies = 200; // Предел длины доказываемой линии
+
+    // Состояние одного доказательства
+    struct State
+    {
+        ProofTable& table;
+        const bool attacker;       // Сторона, выигрыш которой доказывается
+        vector<uint64_t> path;     // Хеши позиций после последнего необратимого хода (партия + путь)
+        size_t no_progress;        // Число обратимых ходов подряд
+        unsigned long long max_nodes;
+        SearchControl* control;
+        unsigned long long nodes = 0;
+        bool aborted = false;
+        size_t ply = 0;
+    };
+
+    // Потомок узла (полный ход)
+    struct Child
+    {
+        vector<vector<POS_T>> mtx;
+        bool reversible; // Тихий ход дамки
+        uint64_t key;
+        uint32_t pn = 1, dn = 1;
+    };
+
+    uint64_t node_key(const vector<vector<POS_T>>& mtx, const bool color, const bool attacker,
+                      const size_t no_progress) const
+    {
+        uint64_t key = Zobrist::hash(mtx, color) ^ (attacker ? 0x6A09E667F3BCC909ull : 0);
+        return key ^ uint64_t(no_progress) * 0xBB67AE8584CAA73Bull;
+    }
+
+    static uint32_t add(const uint32_t a, const uint32_t b)
+    {
+        return min(Infinity, a + b);
+    }
+
+    // Ничья для позиции после хода: повторение после последнего необратимого хода, нет прогресса или предел длины
+    bool is_draw(const State& st, const vector<vector<POS_T>>& mtx, const bool color, const size_t no_progress) const
+    {
+        if (no_progress >= no_progress_limit || st.ply + 1 >= Max_plies)
+            return true;
+        if (no_progress == 0)
+            return false;
+        const uint64_t hash = Zobrist::hash(mtx, color);
+        for (size_t k = 1; k <= no_progress - 1 && k <= st.path.size(); ++k)
+        {
+            if (st.path[st.path.size() - k] == hash)
+                return true;
+        }
+        return false;
+    }
+
+    // Итерация df-pn: расширение узла, пока его pn/dn не выйдут за пороги thpn/thdn
+    void mid(State& st, const vector<vector<POS_T>>& mtx, const bool color, const uint32_t thpn, const uint32_t thdn,
+             uint32_t& pn, uint32_t& dn) const
+    {
+        ++st.nodes;
+        if (!st.aborted && ((st.nodes & 1023) == 0 || st.nodes >= st.max_nodes))
+            st.aborted = st.nodes >= st.max_nodes ||
+                         (st.control && (st.control->stop || SearchControl::now_ms() >= st.control->deadline_ms));
+        const bool is_or = (color == st.attacker);
+        const uint64_t key = node_key(mtx, color, st.attacker, st.no_progress);
+        const auto turns = logic.find_full_turns(color, mtx);
+        if (turns.empty())
+        {
+            // Сторона без ходов проиграла
+            pn = (is_or ? Infinity : 0);
+            dn = (is_or ? 0 : Infinity);
+            st.table.store(key, pn, dn, 1);
+            return;
+        }
+
+        // Потомки: доска после хода и pn/dn из таблицы (ничья - сразу неудача доказывающего)
+        vector<Child> children;
+        children.reserve(turns.size());
+        for (const auto& chain : turns)
+        {
+            Child child;
+            child.mtx = logic.make_turns(mtx, chain);
+            child.reversible = (chain.size() == 1 && chain[0].xb == -1 && mtx[chain[0].x][chain[0].y] > 2);
+            const size_t no_progress = (child.reversible ? st.no_progress + 1 : 0);
+            child.key = node_key(child.mtx, !color, st.attacker, no_progress);
+            if (child.reversible && is_draw(st, child.mtx, !color, no_progress))
+            {
+                child.pn = Infinity;
+                child.dn = 0;
+            }
+            else if (!st.table.lookup(child.key, child.pn, child.dn) && st.ply + 1 >= Max_plies)
+            {
+                child.pn = Infinity;
+                child.dn = 0;
+            }
+            children.push_back(move(child));
+        }
+
+        const unsigned long long start_nodes = st.nodes;
+        while (true)
+        {
+            // OR-узел (ходит доказывающий): pn - минимум, dn - сумма; AND-узел - наоборот
+            uint32_t best_pn = Infinity, best_dn = Infinity, second = Infinity, sum = 0;
+            size_t best = 0;
+            for (size_t k = 0; k < children.size(); ++k)
+            {
+                const uint32_t value = (is_or ? children[k].pn : children[k].dn);
+                sum = add(sum, is_or ? children[k].dn : children[k].pn);
+                if (value < (is_or ? best_pn : best_dn))
+                {
+                    second = (is_or ? best_pn : best_dn);
+                    (is_or ? best_pn : best_dn) = value;
+                    best = k;
+                }
+                else if (value < second)
+                    second = value;
+            }
+            pn = (is_or ? best_pn : sum);
+            dn = (is_or ? sum : best_dn);
+            if (pn >= thpn || dn >= thdn || st.aborted)
+                break;
+
+            // Пороги лучшего потомка: он расширяется, пока не станет хуже второго
+            Child& child = children[best];
+            uint32_t child_thpn, child_thdn;
+            if (is_or)
+            {
+                child_thpn = min(thpn, add(second, 1));
+                child_thdn = (thdn >= Infinity ? Infinity : thdn - dn + child.dn);
+            }
+            else
+            {
+                child_thdn = min(thdn, add(second, 1));
+                child_thpn = (thpn >= Infinity ? Infinity : thpn - pn + child.pn);
+            }
+            const size_t no_progress = st.no_progress;
+            if (child.reversible)
+            {
+                st.path.push_back(Zobrist::hash(mtx, color));
+                ++st.no_progress;
+            }
+            else
+                st.no_progress = 0;
+            ++st.ply;
+            mid(st, child.mtx, !color, child_thpn, child_thdn, child.pn, child.dn);
+            --st.ply;
+            if (child.reversible)
+                st.path.pop_back();
+            st.no_progress = no_progress;
+        }
+        st.table.store(key, pn, dn, uint32_t(min<unsigned long long>(st.nodes - start_nodes + 1, UINT_MAX)));
+    }
+
+    // Доказанная линия по таблице: доказывающий выбирает доказанный ход, защищающийся - любой
+    vector<vector<move_pos>> proven_line(const State& st, vector<vector<POS_T>> mtx, bool color) const
+    {
+        vector<vector<move_pos>> res;
+        size_t no_progress = st.no_progress;
+        while (res.size() < Max_plies)
+        {
+            const auto turns = logic.find_full_turns(color, mtx);
+            const vector<move_pos>* found = nullptr;
+            vector<vector<POS_T>> found_mtx;
+            bool found_reversible = false;
+            for (const auto& chain : turns)
+            {
+                auto next = logic.make_turns(mtx, chain);
+                const bool reversible = (chain.size() == 1 && chain[0].xb == -1 && mtx[chain[0].x][chain[0].y] > 2);
+                uint32_t pn, dn;
+                if (!st.table.lookup(node_key(next, !color, st.attacker, reversible ? no_progress + 1 : 0), pn, dn) ||
+                    pn != 0)
+                    continue;
+                found = &chain;
+                found_mtx = move(next);
+                found_reversible = reversible;
+                break;
+            }
+            if (!found)
+                break;
+            res.push_back(*found);
+            no_progress = (found_reversible ? no_progress + 1 : 0);
+            mtx = move(found_mtx);
+            color = !color;
+        }
+        return res;
+    }
+
+private:
+    const Logic logic;
+    const size_t no_progress_limit;
+};
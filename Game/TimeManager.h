@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Logic.h"
+
+using namespace std;
+
+/**
+ * Распределение времени бота на партию. Бюджет каждого цвета делится на ожидаемое число
+ * его оставшихся ходов (не больше, чем осталось до MaxNumTurns). Во время хода поиск
+ * углубляется итерациями: углубление прекращается раньше, если лучший ход не меняется
+ * несколько итераций подряд, и продлевается (до жесткого предела), если оценка упала.
+ */
+class TimeManager
+{
+public:
+    // Начало партии: бюджет budget_ms на все ходы каждого цвета (0 - без ограничения времени)
+    void start_game(const long long budget_ms)
+    {
+        budget = budget_ms;
+        left_ms[0] = left_ms[1] = budget_ms;
+    }
+
+    bool enabled() const
+    {
+        return budget > 0;
+    }
+
+    /**
+     * Начало хода цвета color.
+     * @param turn_num Номер хода в партии (с 0)
+     * @param max_turns Предел числа ходов партии
+     */
+    void start_turn(const bool color, const int turn_num, const int max_turns)
+    {
+        const long long left = max(left_ms[color], 0ll);
+        const int own_turns = max(1, min((max_turns - turn_num + 1) / 2, Horizon_turns));
+        soft_ms = left / own_turns;
+        hard_ms = min(soft_ms * Max_extension, left);
+        start_ms = last_ms = SearchControl::now_ms();
+        stable = 0;
+        is_extended = false;
+        best.clear();
+    }
+
+    // Момент, после которого поиск прерывается (для SearchControl::deadline_ms)
+    long long deadline_ms() const
+    {
+        return start_ms + hard_ms;
+    }
+
+    /**
+     * Итог очередной итерации углубления: лучший ход turns и его оценка score.
+     * @return true, если следующую итерацию стоит начинать
+     */
+    bool next_iteration(const vector<move_pos>& turns, const double score)
+    {
+        const long long now = SearchControl::now_ms();
+        const long long iteration_ms = now - last_ms;
+        last_ms = now;
+        stable = (!best.empty() && turns == best ? stable + 1 : 0);
+        // Оценка заметно упала - на ход отводится больше времени, чтобы найти защиту
+        if (!best.empty() && score * Drop_ratio < best_score)
+            is_extended = true;
+        best = turns;
+        best_score = score;
+
+        long long limit = soft_ms;
+        if (is_extended)
+            limit = hard_ms;
+        else if (stable + 1 >= Stable_iterations)
+            limit = soft_ms / 2;
+        // Следующая итерация в несколько раз дольше текущей: не начинается, если не успеет
+        return now - start_ms + iteration_ms * Growth < limit;
+    }
+
+    // Конец хода цвета color: потраченное время вычитается из бюджета
+    void end_turn(const bool color)
+    {
+        left_ms[color] -= SearchControl::now_ms() - start_ms;
+    }
+
+    long long soft_limit_ms() const
+    {
+        return soft_ms;
+    }
+
+    long long left(const bool color) const
+    {
+        return left_ms[color];
+    }
+
+private:
+    static constexpr int Horizon_turns = 25;       // Больше своих ходов вперед бюджет не делится
+    static constexpr long long Max_extension = 3;  // Во сколько раз ход может превысить свою долю
+    static constexpr int Stable_iterations = 3;    // После стольких итераций с тем же ходом доля уменьшается вдвое
+    static constexpr double Drop_ratio = 1.1;      // Падение оценки за итерацию, после которого время продлевается
+    static constexpr long long Growth = 3;         // Оценка роста времени следующей итерации
+
+    long long budget = 0;
+    long long left_ms[2] = {0, 0};
+    long long soft_ms = 0, hard_ms = 0;
+    long long start_ms = 0, last_ms = 0;
+    int stable = 0;
+    bool is_extended = false;
+    vector<move_pos> best;
+    double best_score = 0;
+};
@@ -0,0 +1,177 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Memory.h"
+
+using namespace std;
+
+/**
+ * Трассировка фаз игры в формате Chrome trace (chrome://tracing, ui.perfetto.dev).
+ * Включается во время работы (Trace::get().enable()), выключенная точка трассировки
+ * стоит одно чтение атомарного флага. События копятся в буфере потока и пачками
+ * переносятся в общее хранилище (также при завершении потока), dump пишет JSON-файл.
+ */
+class Trace
+{
+public:
+    static constexpr size_t Max_events = 1 << 20; // Предел числа событий (дальше события отбрасываются)
+
+    // Событие "X" (интервал): имя и категория - строковые литералы
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        long long start_us;
+        long long duration_us;
+        int tid;
+        const char* arg_name; // Числовой аргумент события (nullptr - нет)
+        long long arg;
+    };
+
+    static Trace& get()
+    {
+        static Trace trace;
+        return trace;
+    }
+
+    void enable(const bool value)
+    {
+        is_enabled.store(value, memory_order_relaxed);
+    }
+
+    bool enabled() const
+    {
+        return is_enabled.load(memory_order_relaxed);
+    }
+
+    // Микросекунды от запуска процесса
+    long long now_us() const
+    {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    void add(const Event& event)
+    {
+        MemScope mem(MemSubsystem::Log);
+        auto& buffer = local();
+        buffer.events.push_back(event);
+        buffer.events.back().tid = buffer.tid;
+        if (buffer.events.size() >= Batch_size)
+            collect(buffer);
+    }
+
+    /**
+     * Запись всех собранных событий в файл path, после записи буфер событий очищается
+     * (следующий dump содержит только новые события).
+     * Учитываются события завершенных потоков и текущего потока; незаконченные пачки
+     * других работающих потоков попадут в следующий dump.
+     * @return false, если файл не удалось открыть
+     */
+    bool dump(const string& path)
+    {
+        collect(local());
+        lock_guard<mutex> lock(store_mutex);
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f)
+            return false;
+        fputs("{\"traceEvents\":[\n", f);
+        for (size_t k = 0; k < events.size(); ++k)
+        {
+            const Event& e = events[k];
+            fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d",
+                    e.name, e.category, e.start_us, e.duration_us, e.tid);
+            if (e.arg_name)
+                fprintf(f, ",\"args\":{\"%s\":%lld}", e.arg_name, e.arg);
+            fputs(k + 1 < events.size() ? "},\n" : "}\n", f);
+        }
+        fprintf(f, "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%zu}}\n", dropped);
+        fclose(f);
+        events.clear();
+        dropped = 0;
+        return true;
+    }
+
+private:
+    static constexpr size_t Batch_size = 256;
+
+    // Буфер событий потока, при завершении потока события переносятся в хранилище
+    struct ThreadBuffer
+    {
+        vector<Event> events;
+        int tid;
+
+        ~ThreadBuffer()
+        {
+            Trace::get().collect(*this);
+        }
+    };
+
+    Trace() : start(chrono::steady_clock::now())
+    {
+    }
+
+    ThreadBuffer& local()
+    {
+        thread_local ThreadBuffer buffer{{}, next_tid.fetch_add(1, memory_order_relaxed)};
+        return buffer;
+    }
+
+    void collect(ThreadBuffer& buffer)
+    {
+        if (buffer.events.empty())
+            return;
+        lock_guard<mutex> lock(store_mutex);
+        size_t take = min(buffer.events.size(), Max_events - min(Max_events, events.size()));
+        events.insert(events.end(), buffer.events.begin(), buffer.events.begin() + take);
+        dropped += buffer.events.size() - take;
+        buffer.events.clear();
+    }
+
+private:
+    const chrono::steady_clock::time_point start;
+    atomic<bool> is_enabled{false};
+    atomic<int> next_tid{1};
+    mutex store_mutex;
+    vector<Event> events; // События, собранные из буферов потоков
+    size_t dropped = 0;
+};
+
+/**
+ * Точка трассировки: интервал от создания до уничтожения объекта.
+ * Пример: TraceScope trace("rerender", "render");
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* name, const char* category)
+    {
+        if (!Trace::get().enabled())
+            return;
+        event = Trace::Event{name, category, Trace::get().now_us(), 0, 0, nullptr, 0};
+        is_active = true;
+    }
+
+    // Числовой аргумент события (например, число узлов поиска)
+    void arg(const char* name, const long long value)
+    {
+        event.arg_name = name;
+        event.arg = value;
+    }
+
+    ~TraceScope()
+    {
+        if (!is_active)
+            return;
+        event.duration_us = Trace::get().now_us() - event.start_us;
+        Trace::get().add(event);
+    }
+
+private:
+    Trace::Event event{};
+    bool is_active = false;
+};
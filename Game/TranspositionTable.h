@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+/**
+ * Таблица транспозиций (кэш поиска): для позиции хранит оценку с типом границы,
+ * оставшуюся глубину, на которой она получена, и лучший ход.
+ * Общая для всех итераций углубления и всех линий Multi-PV одного поиска, поэтому
+ * повторный проход по уже просчитанным позициям сводится к чтению оценки или
+ * к хорошему первому ходу. Не потокобезопасна: один поиск за раз.
+ */
+class TranspositionTable
+{
+public:
+    // Тип оценки в записи
+    enum class Bound : uint8_t
+    {
+        None,  // Пустая запись
+        Exact, // Точная оценка
+        Lower, // Оценка не меньше записанной (отсечение в узле максимума)
+        Upper  // Оценка не больше записанной (отсечение в узле минимума)
+    };
+
+    struct Entry
+    {
+        uint64_t key = 0;
+        double score = 0;
+        move_pos turn{-1, -1, -1, -1}; // Лучший ход (x == -1 - неизвестен)
+        uint8_t remaining = 0;         // Оставшаяся глубина поиска
+        Bound bound = Bound::None;
+        uint8_t generation = 0;        // Номер поиска, записавшего оценку
+    };
+
+    explicit TranspositionTable(const size_t size_mb = 16)
+    {
+        resize(size_mb);
+    }
+
+    // Размер таблицы в мегабайтах (округляется вниз до степени двойки записей), содержимое очищается
+    void resize(const size_t size_mb)
+    {
+        size_t count = 1024;
+        while (count * 2 * sizeof(Entry) <= size_mb * 1024 * 1024)
+            count *= 2;
+        entries.assign(count, Entry{});
+        mask = count - 1;
+    }
+
+    void clear()
+    {
+        entries.assign(entries.size(), Entry{});
+    }
+
+    // Начало нового поиска: записи прошлых поисков вытесняются в первую очередь
+    void new_search()
+    {
+        ++generation;
+    }
+
+    // Запись позиции key или nullptr
+    const Entry* probe(const uint64_t key) const
+    {
+        const Entry& entry = entries[key & mask];
+        return (entry.bound != Bound::None && entry.key == key) ? &entry : nullptr;
+    }
+
+    // Сохранение оценки: запись этого же поиска с большей глубиной не заменяется
+    void store(const uint64_t key, const double score, const size_t remaining, const Bound bound, const move_pos& turn)
+    {
+        Entry& entry = entries[key & mask];
+        if (entry.bound != Bound::None && entry.generation == generation && entry.remaining > remaining &&
+            entry.key == key)
+            return;
+        entry.key = key;
+        entry.score = score;
+        entry.turn = turn;
+        entry.remaining = uint8_t(min<size_t>(remaining, 255));
+        entry.bound = bound;
+        entry.generation = generation;
+    }
+
+    // Все записи (для сохранения в постоянный кэш)
+    const vector<Entry>& data() const
+    {
+        return entries;
+    }
+
+    // Заполненность таблицы текущим поиском в промилле (по первым 1000 записям)
+    int usage_permille() const
+    {
+        int used = 0;
+        for (size_t k = 0; k < 1000; ++k)
+            used += (entries[k].bound != Bound::None && entries[k].generation == generation);
+        return used;
+    }
+
+private:
+    vector<Entry> entries;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
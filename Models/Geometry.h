@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+
+#include "Move.h"
+
+using namespace std;
+
+/**
+ * Геометрия доски N x N: номера игровых (темных, (x + y) % 2 == 1) клеток и лучи
+ * по диагоналям из каждой клетки. Таблицы строятся при компиляции отдельно для каждого
+ * размера, поэтому генерация ходов идет по готовым лучам без проверок границ доски.
+ */
+template <int N>
+struct Geometry
+{
+    static constexpr POS_T Size = N;
+    static constexpr int Squares = N * N / 2;    // Число игровых клеток
+    static constexpr POS_T Men_rows = N / 2 - 1; // Ряды шашек каждого цвета в начальной расстановке
+
+    // Направления лучей: 0 - вверх-влево, 1 - вверх-вправо, 2 - вниз-влево, 3 - вниз-вправо
+    // (вверх - к строке 0, куда ходят простые белые)
+    struct Cell
+    {
+        POS_T x = 0, y = 0;
+    };
+
+    struct Tables
+    {
+        Cell cell[Squares];            // Клетка по номеру (номера по строкам сверху вниз)
+        Cell ray[Squares][4][N - 1];   // Клетки луча по удалению от начала
+        POS_T ray_size[Squares][4];    // Длина луча
+
+        constexpr Tables() : cell{}, ray{}, ray_size{}
+        {
+            for (int sq = 0; sq < Squares; ++sq)
+            {
+                const POS_T x = POS_T(sq / (N / 2));
+                const POS_T y = POS_T(2 * (sq % (N / 2)) + (x % 2 == 0));
+                cell[sq] = Cell{x, y};
+                for (int dir = 0; dir < 4; ++dir)
+                {
+                    const POS_T dx = (dir < 2 ? -1 : 1), dy = (dir % 2 ? 1 : -1);
+                    POS_T size = 0;
+                    for (POS_T i = x + dx, j = y + dy; i >= 0 && i < N && j >= 0 && j < N; i += dx, j += dy)
+                        ray[sq][dir][size++] = Cell{i, j};
+                    ray_size[sq][dir] = size;
+                }
+            }
+        }
+    };
+
+    static constexpr Tables tables{};
+
+    // Номер игровой клетки (x, y)
+    static constexpr int square(const POS_T x, const POS_T y)
+    {
+        return x * (N / 2) + y / 2;
+    }
+};
+
+// Значение клетки с побитой, но еще не снятой фигурой (турецкий удар, только во время серии взятий)
+constexpr POS_T Captured_piece = 5;
+
+/**
+ * Варианты правил. Общие для обоих: простая бьет назад, дамка дальнобойная, взятие обязательно.
+ * Русские шашки (8 x 8): можно выбрать любую серию взятий, простая, дошедшая до последнего
+ * ряда во время взятия, сразу становится дамкой и продолжает бить как дамка.
+ * Международные шашки (10 x 10): обязательна серия с наибольшим числом взятых фигур,
+ * простая становится дамкой, только если закончила ход на последнем ряду, побитые фигуры
+ * снимаются с доски только после серии (турецкий удар): до того их нельзя ни перепрыгнуть
+ * второй раз, ни пройти через их клетки. На доске 8 x 8 побитая фигура снимается сразу,
+ * как в первой версии Logic и в эталоне Engine/ReferenceLogic.h.
+ */
+struct RussianDraughts : Geometry<8>
+{
+    static constexpr bool Majority_capture = false;
+    static constexpr bool Promote_in_capture = true;
+    static constexpr bool Turkish_strike = false;
+    static constexpr size_t Move_capacity = 160; // У каждой из 12 фигур не больше 13 ходов
+};
+
+struct InternationalDraughts : Geometry<10>
+{
+    static constexpr bool Majority_capture = true;
+    static constexpr bool Promote_in_capture = false;
+    static constexpr bool Turkish_strike = true;
+    static constexpr size_t Move_capacity = 320; // У 20 фигур (дамка - не больше 17 ходов)
+};
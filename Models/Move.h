@@ -14,6 +14,8 @@ struct move_pos
     // -1 значит не битая
     POS_T xb = -1, yb = -1; // beaten
 
+    // пустой ход (для списков ходов фиксированного размера)
+    move_pos() = default;
     // обычный ход шашки
     move_pos(const POS_T x, const POS_T y, const POS_T x2, const POS_T y2) : x(x), y(y), x2(x2), y2(y2)
     {
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "Geometry.h"
+#include "Move.h"
+
+using namespace std;
+
+// Список ходов фиксированной вместимости (без выделения памяти в куче).
+// Создается на стеке на каждом уровне поиска вместо vector<move_pos>.
+// Вместимость N - наибольшее число ходов в позиции варианта правил (Move_capacity).
+template <size_t N>
+class BasicMoveList
+{
+public:
+    static const size_t Capacity = N;
+
+    void clear()
+    {
+        count = 0;
+        have_beats = false;
+    }
+
+    template <class... Args> void emplace_back(Args... args)
+    {
+        if (count == Capacity)
+            throw runtime_error("move list overflow");
+        items[count++] = move_pos(args...);
+    }
+
+    // Удаление первых n ходов (со сдвигом остальных в начало)
+    void erase_front(const size_t n)
+    {
+        for (size_t i = n; i < count; ++i)
+            items[i - n] = items[i];
+        count -= n;
+    }
+
+    // Удаление ходов с номера n до конца
+    void truncate(const size_t n)
+    {
+        count = min(count, n);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return count == 0;
+    }
+    move_pos &operator[](const size_t i)
+    {
+        return items[i];
+    }
+    const move_pos &operator[](const size_t i) const
+    {
+        return items[i];
+    }
+    move_pos *begin()
+    {
+        return items.data();
+    }
+    move_pos *end()
+    {
+        return items.data() + count;
+    }
+    const move_pos *begin() const
+    {
+        return items.data();
+    }
+    const move_pos *end() const
+    {
+        return items.data() + count;
+    }
+
+public:
+    bool have_beats = false; // Список состоит из взятий
+
+private:
+    array<move_pos, Capacity> items;
+    size_t count = 0;
+};
+
+// Список ходов русских шашек
+using MoveList = BasicMoveList<RussianDraughts::Move_capacity>;
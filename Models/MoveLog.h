@@ -0,0 +1,160 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+
+using namespace std;
+
+/**
+ * Журнал ходов партии: вместо копий доски хранятся записи отката (ход, фигура до хода,
+ * побитая фигура, номер взятия в серии) и через каждые Keyframe_interval ходов - снимок доски.
+ * Отмена и повтор хода - O(1), переход к любому ходу - снимок плюс не более
+ * Keyframe_interval записей. Ход здесь - одно перемещение фигуры (одно взятие серии).
+ */
+class MoveLog
+{
+public:
+    static constexpr size_t Keyframe_interval = 32;
+
+    // Начало журнала с позиции start (все прежние записи удаляются)
+    void reset(const vector<vector<POS_T>> &start)
+    {
+        records.clear();
+        keyframes.clear();
+        keyframes.push_back(pack(start));
+        cursor = 0;
+    }
+
+    /**
+     * Выполняет ход turn на доске mtx и записывает его в журнал.
+     * Отмененные ходы после текущего (ветка повтора) отбрасываются.
+     * @param beat_series Номер взятия в серии (0 - тихий ход)
+     */
+    void play(vector<vector<POS_T>> &mtx, const move_pos &turn, const int beat_series = 0)
+    {
+        records.resize(cursor);
+        keyframes.resize(cursor / Keyframe_interval + 1);
+        Record rec{turn, mtx[turn.x][turn.y], POS_T(turn.xb != -1 ? mtx[turn.xb][turn.yb] : 0), int8_t(beat_series)};
+        apply(mtx, rec);
+        records.push_back(rec);
+        if (++cursor % Keyframe_interval == 0)
+            keyframes.push_back(pack(mtx));
+    }
+
+    // Отмена последнего хода на доске mtx, false - отменять нечего
+    bool undo(vector<vector<POS_T>> &mtx)
+    {
+        if (cursor == 0)
+            return false;
+        revert(mtx, records[--cursor]);
+        return true;
+    }
+
+    // Повтор отмененного хода на доске mtx, false - повторять нечего
+    bool redo(vector<vector<POS_T>> &mtx)
+    {
+        if (cursor == records.size())
+            return false;
+        apply(mtx, records[cursor++]);
+        return true;
+    }
+
+    // Переход к позиции после ply ходов (ply не больше size()), доска mtx восстанавливается
+    void seek(const size_t ply, vector<vector<POS_T>> &mtx)
+    {
+        cursor = ply / Keyframe_interval * Keyframe_interval;
+        unpack(keyframes[ply / Keyframe_interval], mtx);
+        while (cursor < ply)
+            apply(mtx, records[cursor++]);
+    }
+
+    // Число сделанных (не отмененных) ходов
+    size_t ply() const
+    {
+        return cursor;
+    }
+
+    // Число записанных ходов, включая отмененные
+    size_t size() const
+    {
+        return records.size();
+    }
+
+    // Номер взятия в серии для последнего сделанного хода (0 - тихий ход или нет ходов)
+    int last_beat_series() const
+    {
+        return cursor ? records[cursor - 1].beat_series : 0;
+    }
+
+    // Номер взятия в серии для следующего отмененного хода (0 - тихий ход или нечего повторять)
+    int next_beat_series() const
+    {
+        return cursor < records.size() ? records[cursor].beat_series : 0;
+    }
+
+    // Сделанные ходы по порядку (для записи партии)
+    vector<move_pos> turns() const
+    {
+        vector<move_pos> res;
+        res.reserve(cursor);
+        for (size_t k = 0; k < cursor; ++k)
+            res.push_back(records[k].turn);
+        return res;
+    }
+
+private:
+    // Запись отката одного хода
+    struct Record
+    {
+        move_pos turn;      // Ход (с побитой фигурой)
+        POS_T piece;        // Фигура до хода (до превращения в дамку)
+        POS_T captured;     // Побитая фигура (0 - без взятия)
+        int8_t beat_series; // Номер взятия в серии
+    };
+
+    // Снимок доски: 64 клетки по 4 бита
+    using Keyframe = array<uint8_t, 32>;
+
+    static void apply(vector<vector<POS_T>> &mtx, const Record &rec)
+    {
+        const move_pos &turn = rec.turn;
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = 0;
+        POS_T piece = rec.piece;
+        if ((piece == 1 && turn.x2 == 0) || (piece == 2 && turn.x2 == 7))
+            piece += 2;
+        mtx[turn.x][turn.y] = 0;
+        mtx[turn.x2][turn.y2] = piece;
+    }
+
+    static void revert(vector<vector<POS_T>> &mtx, const Record &rec)
+    {
+        const move_pos &turn = rec.turn;
+        mtx[turn.x2][turn.y2] = 0;
+        mtx[turn.x][turn.y] = rec.piece;
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = rec.captured;
+    }
+
+    static Keyframe pack(const vector<vector<POS_T>> &mtx)
+    {
+        Keyframe res{};
+        for (size_t k = 0; k < 64; ++k)
+            res[k / 2] |= uint8_t(mtx[k / 8][k % 8] << (k % 2 * 4));
+        return res;
+    }
+
+    static void unpack(const Keyframe &frame, vector<vector<POS_T>> &mtx)
+    {
+        mtx.assign(8, vector<POS_T>(8, 0));
+        for (size_t k = 0; k < 64; ++k)
+            mtx[k / 8][k % 8] = POS_T((frame[k / 2] >> (k % 2 * 4)) & 0xF);
+    }
+
+private:
+    vector<Record> records;     // Записи всех ходов, включая отмененные
+    vector<Keyframe> keyframes; // keyframes[k] - позиция после k * Keyframe_interval ходов
+    size_t cursor = 0;          // Число сделанных ходов
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "Move.h"
+
+using namespace std;
+
+// Текстовая запись клеток, ходов и позиций (используется протоколом движка).
+// Клетка (x, y) матрицы доски записывается как "c3": буква - столбец y (a-h),
+// число - строка снизу вверх (x = 0 соответствует строке 8). На доске 10 x 10 столбцы a-j,
+// строки 1-10 ("a10").
+// Ход с серией взятий записывается через ':' ("c3:e5:c7"), тихий ход - через '-' ("c3-d4").
+// Позиция - 64 (или 100 для доски 10 x 10) символа по строкам сверху вниз:
+// '.' пусто, 'w'/'b' шашки, 'W'/'B' дамки.
+
+// Клетка в текстовом виде (size - размер доски)
+inline string cell_to_str(const POS_T x, const POS_T y, const POS_T size = 8)
+{
+    return char('a' + y) + to_string(size - x);
+}
+
+// Разбор клетки, false если запись некорректна
+inline bool str_to_cell(const string &s, POS_T &x, POS_T &y, const POS_T size = 8)
+{
+    if (s.size() < 2 || s.size() > 3 || s[0] < 'a' || s[0] >= 'a' + size || s[1] == '0')
+        return false;
+    int row = 0;
+    for (size_t k = 1; k < s.size(); ++k)
+    {
+        if (!isdigit((unsigned char)s[k]))
+            return false;
+        row = row * 10 + (s[k] - '0');
+    }
+    if (row > size)
+        return false;
+    x = POS_T(size - row);
+    y = POS_T(s[0] - 'a');
+    return true;
+}
+
+// Запись хода (серии ходов одной фигуры)
+inline string turns_to_str(const vector<move_pos> &turns, const POS_T size = 8)
+{
+    if (turns.empty())
+        return "none";
+    string res = cell_to_str(turns[0].x, turns[0].y, size);
+    for (auto turn : turns)
+    {
+        res += (turn.xb != -1 ? ':' : '-');
+        res += cell_to_str(turn.x2, turn.y2, size);
+    }
+    return res;
+}
+
+// Запись линии: ходы сторон через пробел
+inline string line_to_str(const vector<vector<move_pos>> &line, const POS_T size = 8)
+{
+    string res;
+    for (const auto &turns : line)
+        res += (res.empty() ? "" : " ") + turns_to_str(turns, size);
+    return res.empty() ? "none" : res;
+}
+
+// Разбор хода с восстановлением побитых фигур по доске mtx (ее размер задает запись клеток).
+// Возвращает пустой вектор, если запись некорректна (легальность хода не проверяется)
+inline vector<move_pos> str_to_turns(const string &s, vector<vector<POS_T>> mtx)
+{
+    const POS_T size = POS_T(mtx.size());
+    vector<move_pos> res;
+    POS_T x, y;
+    size_t pos = s.find_first_of("-:");
+    if (pos == string::npos || !str_to_cell(s.substr(0, pos), x, y, size))
+        return {};
+    while (pos != string::npos)
+    {
+        const size_t end = s.find_first_of("-:", pos + 1);
+        POS_T x2, y2;
+        if (!str_to_cell(s.substr(pos + 1, end == string::npos ? string::npos : end - pos - 1), x2, y2, size))
+            return {};
+        if (abs(x2 - x) != abs(y2 - y) || x2 == x || !mtx[x][y])
+            return {};
+        move_pos turn(x, y, x2, y2);
+        // Побитая фигура - единственная фигура на диагонали между клетками
+        POS_T di = (x2 > x ? 1 : -1), dj = (y2 > y ? 1 : -1);
+        for (POS_T i = x + di, j = y + dj; i != x2; i += di, j += dj)
+        {
+            if (mtx[i][j])
+            {
+                turn.xb = i;
+                turn.yb = j;
+                mtx[i][j] = 0;
+                break;
+            }
+        }
+        mtx[x2][y2] = mtx[x][y];
+        mtx[x][y] = 0;
+        res.push_back(turn);
+        x = x2;
+        y = y2;
+        pos = end;
+    }
+    return res;
+}
+
+// Начальная расстановка (startpos): черные в верхних рядах (3 на доске 8 x 8, 4 на 10 x 10), белые в нижних
+inline vector<vector<POS_T>> start_board(const POS_T size = 8)
+{
+    vector<vector<POS_T>> mtx(size, vector<POS_T>(size, 0));
+    const POS_T rows = size / 2 - 1;
+    for (POS_T i = 0; i < size; ++i)
+    {
+        for (POS_T j = 0; j < size; ++j)
+        {
+            if (i < rows && (i + j) % 2 == 1)
+                mtx[i][j] = 2;
+            if (i >= size - rows && (i + j) % 2 == 1)
+                mtx[i][j] = 1;
+        }
+    }
+    return mtx;
+}
+
+// Запись позиции
+inline string board_to_str(const vector<vector<POS_T>> &mtx)
+{
+    const string pieces = ".wbWB";
+    string res;
+    for (const auto &row : mtx)
+        for (POS_T cell : row)
+            res += pieces[cell];
+    return res;
+}
+
+// Разбор позиции (64 символа - доска 8 x 8, 100 - 10 x 10), false если запись некорректна
+// или фигура стоит на светлой клетке
+inline bool str_to_board(const string &s, vector<vector<POS_T>> &mtx)
+{
+    const string pieces = ".wbWB";
+    const size_t size = (s.size() == 100 ? 10 : 8);
+    if (s.size() != size * size)
+        return false;
+    mtx.assign(size, vector<POS_T>(size, 0));
+    for (size_t k = 0; k < s.size(); ++k)
+    {
+        auto type = pieces.find(s[k]);
+        if (type == string::npos || (type && (k / size + k % size) % 2 == 0))
+            return false;
+        mtx[k / size][k % size] = POS_T(type);
+    }
+    return true;
+}
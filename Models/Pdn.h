@@ -0,0 +1,282 @@
+#pragma once
+#include <cctype>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Notation.h"
+
+using namespace std;
+
+// Чтение и запись партий в формате PDN (Portable Draughts Notation) для русских шашек:
+// теги [Ключ "Значение"], затем ходы в алгебраической записи ("c3-d4", "c3:e5" или "c3xe5")
+// с номерами ходов, комментариями {...} и ;..., вариантами (...), NAG $N и результатом.
+// Партии читаются по одной, поэтому размер архива не ограничен памятью.
+
+// Одна партия PDN
+struct PdnGame
+{
+    vector<pair<string, string>> tags; // Теги в порядке записи
+    vector<string> moves;              // Ходы в записи из файла (без номеров, комментариев и оценок)
+    vector<string> annotations;        // Текст после хода при записи (пусто или по одному на ход)
+    string result = "*";
+
+    // Значение тега (пусто, если тега нет)
+    string tag(const string &key) const
+    {
+        for (const auto &item : tags)
+        {
+            if (item.first == key)
+                return item.second;
+        }
+        return "";
+    }
+
+    void set_tag(const string &key, const string &value)
+    {
+        for (auto &item : tags)
+        {
+            if (item.first == key)
+            {
+                item.second = value;
+                return;
+            }
+        }
+        tags.emplace_back(key, value);
+    }
+};
+
+// Потоковое чтение партий PDN
+class PdnReader
+{
+public:
+    explicit PdnReader(istream &in) : in(in)
+    {
+    }
+
+    /**
+     * Читает следующую партию.
+     * @return false, если партий больше нет
+     */
+    bool next(PdnGame &game)
+    {
+        game = PdnGame{};
+        bool has_moves = false, has_tags = false;
+        comment_depth = variation_depth = 0;
+        string line;
+        while (read_line(line))
+        {
+            // Строка тегов после ходов начинает следующую партию (результат не записан)
+            if (!comment_depth && first_char(line) == '[')
+            {
+                if (has_moves)
+                {
+                    pending = line;
+                    has_pending = true;
+                    return true;
+                }
+                parse_tags(line, game);
+                has_tags = true;
+                continue;
+            }
+            if (first_char(line) == '%')
+                continue; // Строка-расширение PDN
+            if (parse_moves(line, game, has_moves))
+                return true;
+        }
+        return has_moves || has_tags;
+    }
+
+private:
+    bool read_line(string &line)
+    {
+        if (has_pending)
+        {
+            has_pending = false;
+            line = pending;
+            return true;
+        }
+        return bool(getline(in, line));
+    }
+
+    static char first_char(const string &line)
+    {
+        auto pos = line.find_first_not_of(" \t\r");
+        return pos == string::npos ? '\0' : line[pos];
+    }
+
+    // Теги строки: [Key "Value"] (в значении \" и \\ экранированы)
+    static void parse_tags(const string &line, PdnGame &game)
+    {
+        size_t pos = 0;
+        while ((pos = line.find('[', pos)) != string::npos)
+        {
+            size_t quote = line.find('"', pos);
+            if (quote == string::npos)
+                return;
+            string key = line.substr(pos + 1, quote - pos - 1);
+            key.erase(key.find_last_not_of(" \t") + 1);
+            string value;
+            for (pos = quote + 1; pos < line.size() && line[pos] != '"'; ++pos)
+            {
+                if (line[pos] == '\\' && pos + 1 < line.size())
+                    ++pos;
+                value += line[pos];
+            }
+            game.tags.emplace_back(key, value);
+        }
+    }
+
+    static bool is_result(const string &token)
+    {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "2-0" || token == "0-2" ||
+               token == "1-1" || token == "0-0" || token == "*";
+    }
+
+    // Разбор строки ходов, true - встречен результат (конец партии)
+    bool parse_moves(const string &line, PdnGame &game, bool &has_moves)
+    {
+        string token;
+        for (size_t pos = 0; pos <= line.size(); ++pos)
+        {
+            const char c = (pos < line.size() ? line[pos] : ' ');
+            if (comment_depth)
+            {
+                comment_depth -= (c == '}');
+                continue;
+            }
+            if (c == '{' || c == '(' || c == ')' || c == ';' || isspace((unsigned char)c))
+            {
+                if (add_token(token, game, has_moves))
+                    return true;
+                token.clear();
+                if (c == '{')
+                    comment_depth = 1;
+                else if (c == '(')
+                    ++variation_depth;
+                else if (c == ')' && variation_depth)
+                    --variation_depth;
+                else if (c == ';')
+                    break;
+                continue;
+            }
+            token += c;
+        }
+        return add_token(token, game, has_moves);
+    }
+
+    bool add_token(string token, PdnGame &game, bool &has_moves)
+    {
+        if (token.empty() || variation_depth)
+            return false;
+        has_moves = true;
+        if (is_result(token))
+        {
+            game.result = token;
+            return true;
+        }
+        if (token[0] == '$')
+            return false; // NAG
+        // Номер хода "12." или "12..." (может быть слитно с ходом)
+        size_t digits = 0;
+        while (digits < token.size() && isdigit((unsigned char)token[digits]))
+            ++digits;
+        if (digits && digits < token.size() && token[digits] == '.')
+        {
+            const size_t start = token.find_first_not_of('.', digits);
+            token = (start == string::npos ? "" : token.substr(start));
+        }
+        // Оценки хода "!", "?", "+" и т.п.
+        token.erase(token.find_last_not_of("!?+#") + 1);
+        if (!token.empty())
+            game.moves.push_back(token);
+        return false;
+    }
+
+private:
+    istream &in;
+    string pending; // Строка, прочитанная наперед (теги следующей партии)
+    bool has_pending = false;
+    int comment_depth = 0, variation_depth = 0;
+};
+
+// Запись партии PDN; ходы нумеруются с учетом того, кто ходит первым (тег FEN)
+inline void write_pdn(ostream &out, const PdnGame &game)
+{
+    for (const auto &item : game.tags)
+    {
+        out << '[' << item.first << " \"";
+        for (char c : item.second)
+            out << ((c == '"' || c == '\\') ? "\\" : "") << c;
+        out << "\"]\n";
+    }
+    out << '\n';
+    const string fen = game.tag("FEN");
+    const size_t black_first = (!fen.empty() && fen[0] == 'B');
+    string line;
+    auto add = [&](const string &text) {
+        if (!line.empty() && line.size() + 1 + text.size() > 79)
+        {
+            out << line << '\n';
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + text;
+    };
+    for (size_t k = 0; k < game.moves.size(); ++k)
+    {
+        const size_t ply = k + black_first;
+        string text;
+        if (ply % 2 == 0)
+            text = to_string(ply / 2 + 1) + ". ";
+        else if (k == 0)
+            text = to_string(ply / 2 + 1) + "... ";
+        text += game.moves[k];
+        if (k < game.annotations.size() && !game.annotations[k].empty())
+            text += game.annotations[k];
+        add(text);
+    }
+    add(game.result);
+    out << line << "\n\n";
+}
+
+/**
+ * Разбор начальной позиции из тега FEN в алгебраической записи: "W:Wc3,e3,Kd4:Bb6,f6"
+ * (первая буква - кто ходит, K - дамка). Номерная запись клеток не поддерживается.
+ * @return false, если запись некорректна
+ */
+inline bool fen_to_board(const string &fen, vector<vector<POS_T>> &mtx, bool &color)
+{
+    if (fen.size() < 1 || (fen[0] != 'W' && fen[0] != 'B'))
+        return false;
+    color = (fen[0] == 'B');
+    mtx.assign(8, vector<POS_T>(8, 0));
+    size_t pos = 1;
+    while (pos < fen.size())
+    {
+        if (fen[pos] != ':' || pos + 1 >= fen.size() || (fen[pos + 1] != 'W' && fen[pos + 1] != 'B'))
+            return false;
+        const POS_T man = (fen[pos + 1] == 'W' ? 1 : 2);
+        pos += 2;
+        while (pos < fen.size() && fen[pos] != ':')
+        {
+            size_t end = fen.find_first_of(",:", pos);
+            if (end == string::npos)
+                end = fen.size();
+            string square = fen.substr(pos, end - pos);
+            POS_T piece = man;
+            if (!square.empty() && square[0] == 'K')
+            {
+                piece += 2;
+                square = square.substr(1);
+            }
+            POS_T x, y;
+            if (!str_to_cell(square, x, y) || (x + y) % 2 == 0)
+                return false;
+            mtx[x][y] = piece;
+            pos = (end < fen.size() && fen[end] == ',' ? end + 1 : end);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+#include "Zobrist.h"
+
+using namespace std;
+
+// История позиций партии для правил ничьей: позиция в начале каждого хода.
+// Обратимым считается тихий ход дамки (простые шашки и число фигур не изменились).
+class PositionHistory
+{
+public:
+    void clear()
+    {
+        records.clear();
+    }
+
+    // Запоминает позицию в начале хода turn_num (записи отмененных ходов отбрасываются)
+    void add(const vector<vector<POS_T>> &mtx, const int turn_num)
+    {
+        records.resize(turn_num);
+        Record rec{Zobrist::hash(mtx, turn_num % 2), Zobrist::men_hash(mtx), 0};
+        if (!records.empty() && records.back().men_hash == rec.men_hash)
+            rec.no_progress = records.back().no_progress + 1;
+        records.push_back(rec);
+    }
+
+    /**
+     * Ничья в последней позиции: она повторилась repetitions раз после последнего
+     * необратимого хода или no_progress_turns ходов подряд были обратимыми.
+     */
+    bool is_draw(const int repetitions, const int no_progress_turns) const
+    {
+        if (records.empty())
+            return false;
+        const Record &last = records.back();
+        int count = 0;
+        for (int k = 0; k <= last.no_progress; ++k)
+            count += (records[records.size() - 1 - k].hash == last.hash);
+        return count >= repetitions || last.no_progress >= no_progress_turns;
+    }
+
+    // Хеши позиций после последнего необратимого хода (без текущей) - для поиска бота
+    vector<uint64_t> since_irreversible() const
+    {
+        vector<uint64_t> res;
+        if (records.empty())
+            return res;
+        for (size_t k = records.size() - 1 - records.back().no_progress; k + 1 < records.size(); ++k)
+            res.push_back(records[k].hash);
+        return res;
+    }
+
+private:
+    struct Record
+    {
+        uint64_t hash;     // Хеш позиции с очередью хода
+        uint64_t men_hash; // Хеш простых шашек и числа фигур
+        int no_progress;   // Число обратимых ходов подряд перед этой позицией
+    };
+    vector<Record> records;
+};
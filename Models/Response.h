@@ -7,5 +7,6 @@ enum class Response
     BACK, // отмена или возврат хода
     REPLAY, // перезапуск игры 
     QUIT, // выход из игры
-    CELL // указываем на дейсвтие с клеткой
+    CELL, // указываем на дейсвтие с клеткой
+    WAKE // ожидание ввода прервано (пробуждение из другого потока или таймаут)
 };
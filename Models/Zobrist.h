@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+
+using namespace std;
+
+// Хеширование позиций по Зобристу: каждой паре (клетка, фигура) и очереди хода черных
+// сопоставлено случайное 64-битное число, хеш позиции - XOR чисел всех ее фигур.
+// Используется для обнаружения повторений позиций. Доски 8 x 8 и 10 x 10 хешируются
+// по своим таблицам.
+class Zobrist
+{
+public:
+    // Хеш позиции с учетом очереди хода (false - белые, true - черные)
+    static uint64_t hash(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        return mtx.size() == 10 ? hash<10>(mtx, color) : hash<8>(mtx, color);
+    }
+
+    // Хеш расстановки простых шашек и числа фигур: не меняется только при тихом ходе дамки
+    static uint64_t men_hash(const vector<vector<POS_T>> &mtx)
+    {
+        return mtx.size() == 10 ? men_hash<10>(mtx) : men_hash<8>(mtx);
+    }
+
+private:
+    template <int N> struct Keys
+    {
+        // [строка][столбец][тип фигуры], тип 0 - пусто, 5 - побитая фигура во время серии взятий
+        array<array<array<uint64_t, 6>, N>, N> piece;
+        uint64_t black_turn;
+    };
+
+    template <int N> static uint64_t hash(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        const auto &keys = table<N>();
+        uint64_t res = color ? keys.black_turn : 0;
+        for (POS_T i = 0; i < N; ++i)
+            for (POS_T j = 0; j < N; ++j)
+                res ^= keys.piece[i][j][mtx[i][j]];
+        return res;
+    }
+
+    template <int N> static uint64_t men_hash(const vector<vector<POS_T>> &mtx)
+    {
+        const auto &keys = table<N>();
+        uint64_t res = 0;
+        for (POS_T i = 0; i < N; ++i)
+        {
+            for (POS_T j = 0; j < N; ++j)
+            {
+                if (mtx[i][j] == 1 || mtx[i][j] == 2)
+                    res ^= keys.piece[i][j][mtx[i][j]];
+                else if (mtx[i][j])
+                    res += keys.black_turn; // Дамки учитываются только количеством
+            }
+        }
+        return res;
+    }
+
+    // Таблица случайных чисел (генератор splitmix64 с фиксированным зерном, одинакова между запусками)
+    template <int N> static const Keys<N> &table()
+    {
+        static const Keys<N> keys = [] {
+            Keys<N> res{};
+            uint64_t state = 0x9E3779B97F4A7C15ull;
+            auto next = [&state] {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            };
+            for (auto &row : res.piece)
+                for (auto &cell : row)
+                    for (POS_T type = 1; type < 5; ++type)
+                        cell[type] = next();
+            res.black_turn = next();
+            // Ключи побитых фигур - после остальных, чтобы хеши обычных позиций не изменились
+            for (auto &row : res.piece)
+                for (auto &cell : row)
+                    cell[5] = next();
+            return res;
+        }();
+        return keys;
+    }
+};
@@ -0,0 +1,389 @@
+// Консольный движок без окна SDL.
+// engine                                  - протокол Engine поверх stdin/stdout
+// engine server <socket> [threads] [budget_ms] - многопартийный сервер на Unix-сокете
+// engine match [games] [depth] [first_opt] [second_opt] [second_depth] - матч двух уровней оптимизации
+//   (по умолчанию O1 против O2 на одной глубине)
+// engine bestmove <startpos|startpos10|позиция из 64 или 100 символов> [w|b] [depth] [multipv] - лучшие ходы
+//   в позиции и выход (доска 10 x 10 - международные шашки)
+// engine analyse <in.pdn|-> <out.pdn|-> [depth] [movetime_ms] [threads] - пакетный анализ партий PDN
+// engine solve <startpos|позиция из 64 символов> [w|b] [nodes] - доказательство выигрыша или проигрыша
+// engine index <in.pdn|-> <db> - построение базы позиций из партий PDN
+// engine query <db> <startpos|позиция из 64 символов> [w|b] - статистика позиции в базе
+// engine fuzz [positions] [depth] [seed] [O0|O1] - сверка генерации ходов и поиска с эталонными правилами
+#include <fstream>
+#include <iostream>
+
+#include "Engine/Analyzer.h"
+#include "Engine/Engine.h"
+#include "Engine/Fuzzer.h"
+#include "Engine/Indexer.h"
+#include "Engine/Match.h"
+#include "Engine/Server.h"
+#include "Game/MemoryHooks.h"
+#include "Game/Solver.h"
+
+// Краткая справка по режимам (при ошибке в параметрах)
+const char* const Usage = "usage:\n"
+                          "  engine\n"
+                          "  engine server <socket> [threads] [budget_ms]\n"
+                          "  engine match [games] [depth] [first_opt] [second_opt] [second_depth]\n"
+                          "  engine bestmove <startpos|startpos10|board> [w|b] [depth] [multipv]\n"
+                          "  engine analyse <in.pdn|-> <out.pdn|-> [depth] [movetime_ms] [threads]\n"
+                          "  engine solve <startpos|board> [w|b] [nodes]\n"
+                          "  engine index <in.pdn|-> <db>\n"
+                          "  engine query <db> <startpos|board> [w|b]\n"
+                          "  engine fuzz [positions] [depth] [seed] [O0|O1]\n";
+
+// Целый параметр командной строки не меньше min_value (иначе исключение - ошибка с подсказкой Usage)
+int int_arg(const char* arg, const int min_value)
+{
+    size_t end = 0;
+    const int value = stoi(arg, &end);
+    if (arg[end] != '\0')
+        throw invalid_argument(arg);
+    if (value < min_value)
+        throw out_of_range(arg);
+    return value;
+}
+
+// Движок собирается без SDL: окно и ввод подключаются только в main.cpp
+#if defined(SDL_h_) || defined(_SDL_H) || defined(SDL_IMAGE_H_) || defined(_SDL_IMAGE_H)
+#error "engine.cpp must not include SDL headers"
+#endif
+
+// Поиск в позиции варианта правил Variant и печать линий и лучшего хода
+template <class Variant>
+void print_best_move(const Config& config, const vector<vector<POS_T>>& mtx, const bool color, const SearchParams& params)
+{
+    const BasicLogic<Variant> logic(&config);
+    const auto start = SearchControl::now_ms();
+    const SearchResult res = logic.find_best_turns(mtx, color, params);
+    for (size_t k = 0; k < res.lines.size(); ++k)
+    {
+        cout << "info depth " << params.depth;
+        if (params.multi_pv > 1)
+            cout << " multipv " << k + 1;
+        cout << " nodes " << res.nodes << " time " << SearchControl::now_ms() - start << " score "
+             << Engine::score_to_str(res.lines[k].score) << " pv " << line_to_str(res.lines[k].turns, Variant::Size)
+             << endl;
+    }
+    cout << "bestmove " << turns_to_str(res.turns, Variant::Size) << endl;
+}
+
+// Лучший ход в одной позиции (без протокола): печатает "info ..." (по строке на линию) и "bestmove <ход>".
+// Позиция 10 x 10 (startpos10 или 100 символов) считается по международным правилам
+int best_move(const Config& config, int argc, char* argv[])
+{
+    vector<vector<POS_T>> mtx;
+    const string position = argv[2];
+    if (position == "startpos" || position == "startpos10")
+        mtx = start_board(position == "startpos" ? 8 : 10);
+    else if (!str_to_board(position, mtx))
+    {
+        cerr << "bad position " << position << endl;
+        return 1;
+    }
+    const string side = (argc > 3 ? argv[3] : "w");
+    if (side != "w" && side != "b")
+    {
+        cerr << "bad side " << side << ", expected w or b" << endl;
+        return 1;
+    }
+    const bool color = (side == "b");
+    SearchParams params;
+    params.depth = (argc > 4 ? int_arg(argv[4], 0) : config.settings().bot.level[color]);
+    params.multi_pv = (argc > 5 ? int_arg(argv[5], 1) : 1);
+    unique_ptr<TranspositionTable> tt;
+    if (config.settings().bot.hash_mb > 0)
+        tt = make_unique<TranspositionTable>(size_t(config.settings().bot.hash_mb));
+    params.tt = tt.get();
+
+    if (mtx.size() == 10)
+        print_best_move<InternationalDraughts>(config, mtx, color, params);
+    else
+        print_best_move<RussianDraughts>(config, mtx, color, params);
+    return 0;
+}
+
+// Решение позиции df-pn: "info solve win|loss|unknown nodes N time MS pv ..." и "bestmove <ход>"
+int solve(const Config& config, int argc, char* argv[])
+{
+    vector<vector<POS_T>> mtx;
+    const string position = argv[2];
+    if (position == "startpos")
+        mtx = start_board();
+    else if (!str_to_board(position, mtx) || mtx.size() != 8)
+    {
+        cerr << "bad position " << position << endl;
+        return 1;
+    }
+    const string side = (argc > 3 ? argv[3] : "w");
+    if (side != "w" && side != "b")
+    {
+        cerr << "bad side " << side << ", expected w or b" << endl;
+        return 1;
+    }
+    const bool color = (side == "b");
+    const auto& settings = config.settings().solver;
+    const unsigned long long max_nodes = (argc > 4 ? stoull(argv[4]) : settings.max_nodes);
+
+    const Solver solver(&config);
+    ProofTable table(size_t(settings.table_mb));
+    const auto start = SearchControl::now_ms();
+    const auto res = solver.solve(mtx, color, {}, table, max_nodes);
+    const char* outcome[] = {"unknown", "win", "loss"};
+    cout << "info solve " << outcome[int(res.outcome)] << " nodes " << res.nodes << " time "
+         << SearchControl::now_ms() - start << " pv " << line_to_str(res.line) << endl;
+    cout << "bestmove " << (res.outcome == SolveResult::Outcome::Win ? turns_to_str(res.line[0]) : "none") << endl;
+    return 0;
+}
+
+// Пакетный анализ партий: "-" вместо файла - stdin/stdout, итог печатается в stderr
+int analyse(const Config& config, int argc, char* argv[])
+{
+    const string in_path = argv[2], out_path = argv[3];
+    ifstream fin;
+    ofstream fout;
+    if (in_path != "-")
+    {
+        fin.open(in_path);
+        if (!fin)
+        {
+            cerr << "can't open " << in_path << endl;
+            return 1;
+        }
+    }
+    if (out_path != "-")
+    {
+        fout.open(out_path);
+        if (!fout)
+        {
+            cerr << "can't open " << out_path << endl;
+            return 1;
+        }
+    }
+    Analyzer::Options options;
+    options.depth = (argc > 4 ? int_arg(argv[4], 0) : max(config.settings().bot.level[0], config.settings().bot.level[1]));
+    options.movetime_ms = (argc > 5 ? stoll(argv[5]) : 0);
+    options.threads = (argc > 6 ? unsigned(stoul(argv[6])) : 0);
+
+    const auto start = SearchControl::now_ms();
+    Analyzer analyzer(&config, options);
+    const auto stats = analyzer.run(in_path == "-" ? cin : fin, out_path == "-" ? cout : fout);
+    cerr << "games " << stats.games << " positions " << stats.positions << " mistakes " << stats.mistakes
+         << " blunders " << stats.blunders << " errors " << stats.errors << " time_ms "
+         << SearchControl::now_ms() - start << endl;
+    return 0;
+}
+
+// Построение базы позиций: "-" вместо файла партий - stdin, итог печатается в stderr
+int build_index(const Config& config, char* argv[])
+{
+    const string in_path = argv[2];
+    ifstream fin;
+    if (in_path != "-")
+    {
+        fin.open(in_path);
+        if (!fin)
+        {
+            cerr << "can't open " << in_path << endl;
+            return 1;
+        }
+    }
+    const auto start = SearchControl::now_ms();
+    Indexer indexer(&config, argv[3]);
+    Indexer::Stats stats;
+    string error;
+    if (!indexer.run(in_path == "-" ? cin : fin, stats, &error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+    cerr << "games " << stats.games << " positions " << stats.positions << " errors " << stats.errors << " time_ms "
+         << SearchControl::now_ms() - start << endl;
+    return 0;
+}
+
+// Статистика позиции в базе: "position games N wins W draws D losses L" (с точки зрения ходящего)
+// и по строке "move M games N wins W draws D losses L" на каждый сыгранный ход
+int query(int argc, char* argv[])
+{
+    const PositionDb db(argv[2]);
+    if (!db.is_open())
+    {
+        cerr << "can't open position database " << argv[2] << endl;
+        return 1;
+    }
+    vector<vector<POS_T>> mtx;
+    const string position = argv[3];
+    if (position == "startpos")
+        mtx = start_board();
+    else if (!str_to_board(position, mtx) || mtx.size() != 8)
+    {
+        cerr << "bad position " << position << endl;
+        return 1;
+    }
+    const string side = (argc > 4 ? argv[4] : "w");
+    if (side != "w" && side != "b")
+    {
+        cerr << "bad side " << side << ", expected w or b" << endl;
+        return 1;
+    }
+    PositionDb::Stats stats;
+    db.probe(mtx, side == "b", stats);
+    auto print = [](const PositionDb::Counts& counts) {
+        cout << " games " << counts.games << " wins " << counts.wins << " draws " << counts.draws << " losses "
+             << counts.losses << endl;
+    };
+    cout << "position";
+    print(stats.counts);
+    for (const auto& item : stats.moves)
+    {
+        cout << "move " << turns_to_str(item.turns);
+        print(item.counts);
+    }
+    return 0;
+}
+
+// Сверка Logic с эталоном: расхождения печатаются по строке "mismatch ...", код возврата 1, если они есть
+int fuzz(Config config, int argc, char* argv[])
+{
+    Fuzzer::Options options;
+    if (argc > 2)
+        options.positions = stoull(argv[2]);
+    if (argc > 3)
+        options.depth = int_arg(argv[3], 0);
+    if (argc > 4)
+        options.seed = unsigned(stoul(argv[4]));
+    // Выборочный поиск O2 по определению может расходиться с минимаксом, поэтому сверяются O0 и O1
+    const string optimization = (argc > 5 ? argv[5] : "O1");
+    if (optimization != "O0" && optimization != "O1")
+    {
+        cerr << "bad optimization " << optimization << ", expected O0 or O1" << endl;
+        return 1;
+    }
+    config.set("Bot", "Optimization", optimization);
+
+    const auto start = SearchControl::now_ms();
+    Fuzzer fuzzer(&config, options);
+    const auto stats = fuzzer.run(cout);
+    cout << "positions " << stats.positions << " turns " << stats.turns << " searches " << stats.searches
+         << " mismatches " << stats.mismatches << " time_ms " << SearchControl::now_ms() - start << endl;
+    return stats.mismatches ? 1 : 0;
+}
+
+int run(int argc, char* argv[])
+{
+    Config config;
+    const string mode = (argc > 1 ? argv[1] : "");
+    if (mode == "server")
+    {
+        if (argc < 3)
+        {
+            cerr << "usage: engine server <socket> [threads] [budget_ms]" << endl;
+            return 1;
+        }
+        unsigned threads = (argc > 3 ? unsigned(stoul(argv[3])) : 0);
+        long long budget_ms = (argc > 4 ? stoll(argv[4]) : -1);
+        Server server(&config, threads, budget_ms);
+        return server.run(argv[2]);
+    }
+    if (mode == "bestmove")
+    {
+        if (argc < 3)
+        {
+            cerr << "usage: engine bestmove <startpos|startpos10|board> [w|b] [depth] [multipv]" << endl;
+            return 1;
+        }
+        return best_move(config, argc, argv);
+    }
+    if (mode == "solve")
+    {
+        if (argc < 3)
+        {
+            cerr << "usage: engine solve <startpos|board> [w|b] [nodes]" << endl;
+            return 1;
+        }
+        return solve(config, argc, argv);
+    }
+    if (mode == "analyse")
+    {
+        if (argc < 4)
+        {
+            cerr << "usage: engine analyse <in.pdn|-> <out.pdn|-> [depth] [movetime_ms] [threads]" << endl;
+            return 1;
+        }
+        return analyse(config, argc, argv);
+    }
+    if (mode == "index")
+    {
+        if (argc < 4)
+        {
+            cerr << "usage: engine index <in.pdn|-> <db>" << endl;
+            return 1;
+        }
+        return build_index(config, argv);
+    }
+    if (mode == "query")
+    {
+        if (argc < 4)
+        {
+            cerr << "usage: engine query <db> <startpos|board> [w|b]" << endl;
+            return 1;
+        }
+        return query(argc, argv);
+    }
+    if (mode == "fuzz")
+        return fuzz(config, argc, argv);
+    if (mode == "match")
+    {
+        const int games = (argc > 2 ? int_arg(argv[2], 1) : 20);
+        const int depth = (argc > 3 ? int_arg(argv[3], 0) : 6);
+        const int second_depth = (argc > 6 ? int_arg(argv[6], 0) : depth);
+        Config first_config = config, second_config = config;
+        first_config.set("Bot", "Optimization", argc > 4 ? argv[4] : "O1");
+        second_config.set("Bot", "Optimization", argc > 5 ? argv[5] : "O2");
+        const Logic first_logic(&first_config), second_logic(&second_config);
+        Match::Side first(&first_logic, depth), second(&second_logic, second_depth);
+        Match match(&config);
+        for (int game = 0; game < games; ++game)
+            match.play_game(first, second, game % 2 == 0);
+        cout << first_config("Bot", "Optimization").get<string>() << ": " << first.report() << endl;
+        cout << second_config("Bot", "Optimization").get<string>() << ": " << second.report() << endl;
+        cout << "peak_rss_kb " << Memory::peak_resident_bytes() / 1024 << " search_arena_mb "
+             << config.settings().bot.arena_mb << " arena_overflows " << Memory::arena_overflows() << endl;
+        return 0;
+    }
+
+    Engine engine(&config, [](const string& line) { cout << line << endl; });
+    string line;
+    while (getline(cin, line))
+    {
+        if (!engine.handle(line))
+            break;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        return run(argc, argv);
+    }
+    catch (const runtime_error& e) // Некорректные настройки или параметры матча
+    {
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+    catch (const logic_error& e) // Числовой параметр не число или вне диапазона (int_arg, stoull)
+    {
+        cerr << "error: bad numeric argument (" << e.what() << ")" << endl << Usage;
+        return 1;
+    }
+    catch (const exception& e)
+    {
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+}
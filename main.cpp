@@ -1,9 +1,18 @@
 #include "Game/Game.h"
+#include "Game/MemoryHooks.h"
 
 int main(int argc, char* argv[])
 {
-    Game g;
-    g.play();
+    try
+    {
+        Game g;
+        g.play();
+    }
+    catch (const runtime_error& e) // Некорректные настройки обнаруживаются при запуске
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
 
     return 0;
 }